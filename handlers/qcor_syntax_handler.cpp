@@ -419,6 +419,27 @@ void QCORSyntaxHandler::GetReplacement(
     OS << ");\n";   
     // The rest: either inline unpacking or temp var names (ref type)
     OS << "}\n";
+
+    // Typed fast path (no HetMap marshalling): args is a packed buffer of
+    // pointers to the kernel arguments, in the kernel signature order.
+    // Reference args bind directly to the pointed-to values.
+    std::stringstream packed_args_ss;
+    for (int i = 0; i < program_arg_types.size(); i++) {
+      packed_args_ss << (i == 0 ? "" : ", ") << "*reinterpret_cast<"
+                     << "std::remove_reference_t<" << program_arg_types[i]
+                     << "> *>(args[" << i << "])";
+    }
+    OS << "void " << kernel_name << "__with_packed_args(void **args) {\n";
+    OS << "class " << kernel_name << " __ker__temp__(" << packed_args_ss.str()
+       << ");\n";
+    OS << "}\n";
+
+    OS << "void " << kernel_name
+       << "__with_parent_and_packed_args(std::shared_ptr<CompositeInstruction> "
+          "parent, void **args) {\n";
+    OS << "class " << kernel_name << " __ker__temp__(parent, "
+       << packed_args_ss.str() << ");\n";
+    OS << "}\n";
   }
   auto s = OS.str();
   qcor::info("[qcor syntax-handler] Rewriting " + kernel_name + " to\n\n" + s);
@@ -444,6 +465,12 @@ class QCORArgs : public PluginASTAction {
 
   bool ParseArgs(const CompilerInstance &CI,
                  const std::vector<std::string> &args) override {
+    // Reset the options, the plugin may stay loaded across
+    // compiles (qcor-server).
+    qpu_name = "qpp";
+    shots = 0;
+    qrt = false;
+    bool verbose = false;
     for (unsigned i = 0, e = args.size(); i != e; ++i) {
       // Example error handling.
       DiagnosticsEngine &D = CI.getDiagnostics();
@@ -465,11 +492,12 @@ class QCORArgs : public PluginASTAction {
         ++i;
         shots = std::stoi(args[i]);
       } else if (args[i] == "-qcor-verbose") {
-        qcor::set_verbose(true);
+        verbose = true;
       } else if (args[i] == "-qrt") {
         qrt = true;
       }
     }
+    qcor::set_verbose(verbose);
     return true;
   }
 
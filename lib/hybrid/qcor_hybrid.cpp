@@ -1,5 +1,6 @@
 #include "qcor_hybrid.hpp"
 #include "Compiler.hpp"
+#include "qcor_diagonal_qaoa.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include <Utils.hpp>
@@ -22,6 +23,53 @@ TranslationFunctorAutoGenerator::operator()(
 
 void QAOA::error(const std::string &message) { xacc::error(message); }
 
+QAOA::QAOAResultType
+QAOA::execute_diagonal(std::shared_ptr<Optimizer> optimizer,
+                       const std::vector<double> &init_params) {
+  if (!DiagonalQaoaSimulator::is_diagonal(cost)) {
+    error("QAOA 'diagonal-simulation' requires a cost hamiltonian with Z "
+          "terms only.");
+  }
+  // One beta per reference hamiltonian term: exp(-i beta c_j X_j)
+  if (!DiagonalQaoaSimulator::is_x_mixer(ref)) {
+    error("QAOA 'diagonal-simulation' requires a reference hamiltonian with "
+          "single-qubit X terms only.");
+  }
+  DiagonalQaoaSimulator simulator(cost, ref);
+  const std::size_t nGamma = n_gamma();
+  const std::size_t nBeta = n_beta();
+
+  // Same parameter layout as qaoa_ansatz:
+  // x = [gamma(step, cost term)..., beta(step, qubit)...]
+  OptFunction f(
+      [&](const std::vector<double> &x, std::vector<double> &dx) {
+        std::vector<std::vector<double>> gammas(nSteps), betas(nSteps);
+        for (std::size_t step = 0; step < nSteps; step++) {
+          auto gamma_begin = x.begin() + step * nGamma;
+          auto beta_begin = x.begin() + nSteps * nGamma + step * nBeta;
+          gammas[step].assign(gamma_begin, gamma_begin + nGamma);
+          betas[step].assign(beta_begin, beta_begin + nBeta);
+        }
+        if (dx.empty()) {
+          return simulator.expectation(gammas, betas);
+        }
+        std::vector<std::vector<double>> gamma_grads, beta_grads;
+        const double energy =
+            simulator.expectation(gammas, betas, &gamma_grads, &beta_grads);
+        for (std::size_t step = 0; step < nSteps; step++) {
+          std::copy(gamma_grads[step].begin(), gamma_grads[step].end(),
+                    dx.begin() + step * nGamma);
+          std::copy(beta_grads[step].begin(), beta_grads[step].end(),
+                    dx.begin() + nSteps * nGamma + step * nBeta);
+        }
+        return energy;
+      },
+      n_parameters());
+
+  optimizer->appendOption("initial-parameters", init_params);
+  return optimizer->optimize(f);
+}
+
 
 void execute_qite(qreg q, const HeterogeneousMap &&m) {
   auto qite = xacc::getAlgorithm("qite", m);
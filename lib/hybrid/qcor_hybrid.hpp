@@ -6,6 +6,7 @@
 #include "qcor_utils.hpp"
 #include "qrt.hpp"
 #include <memory>
+#include <set>
 #include <xacc_internal_compiler.hpp>
 
 namespace qcor {
@@ -78,6 +79,28 @@ protected:
 
   HeterogeneousMap options;
 
+  // Evaluation history of the objective, only set if enabled via the
+  // history-size / history-file options. It holds the most recent
+  // history-size evaluations, accumulated across execute() calls
+  // made with the same history options.
+  std::shared_ptr<OptimizationHistory> history;
+
+  // True if the history is the only record of the evaluations, i.e.
+  // the per-evaluation child buffers were not kept in q
+  bool children_dropped() {
+    return history && q.results()->getChildren().empty();
+  }
+
+  void warn_if_truncated() {
+    if (history->total_recorded() > history->size()) {
+      std::cerr << "QCOR VQE Warning - only the last " << history->size()
+                << " of " << history->total_recorded()
+                << " evaluations are held in memory, set "
+                   "history-keep-children or history-file to keep all of "
+                   "them.\n";
+    }
+  }
+
 public:
   // Typedef for describing the energy / params return type
   using VQEResultType = std::pair<double, std::vector<double>>;
@@ -161,6 +184,7 @@ public:
     }
     options.insert("observable", __internal__::qcor_as_shared(&observable));
     objective->set_options(options);
+    history = objective->get_history();
     return optimizer->optimize(*objective.get());
   }
 
@@ -191,8 +215,21 @@ public:
     return (*objective)(x);
   }
 
-  // Return all unique parameter sets this VQE run used
+  // Return all unique parameter sets this VQE run used.
+  // If a history is enabled without history-keep-children, only the
+  // evaluations held by the history are available (see get_history()).
   std::vector<std::vector<double>> get_unique_parameters() {
+    if (children_dropped()) {
+      warn_if_truncated();
+      std::set<std::vector<double>> seen;
+      std::vector<std::vector<double>> ret;
+      for (auto &entry : history->entries()) {
+        if (seen.insert(entry.parameters).second) {
+          ret.push_back(entry.parameters);
+        }
+      }
+      return ret;
+    }
     auto tmp_ei = q.results()->getAllUnique("parameters");
     std::vector<std::vector<double>> ret;
     for (auto &ei : tmp_ei) {
@@ -201,8 +238,22 @@ public:
     return ret;
   }
 
-  // Return all energies seen at their corresponding parameter sets
+  // Return all energies seen at their corresponding parameter sets,
+  // same history caveat as get_unique_parameters()
   VQEEnergiesAndParameters get_unique_energies() {
+    if (children_dropped()) {
+      warn_if_truncated();
+      std::set<std::vector<double>> seen;
+      VQEEnergiesAndParameters ret;
+      for (auto &entry : history->entries()) {
+        auto key = entry.parameters;
+        key.push_back(entry.energy);
+        if (seen.insert(key).second) {
+          ret.push_back(std::make_pair(entry.energy, entry.parameters));
+        }
+      }
+      return ret;
+    }
     auto tmp_ei = q.results()->getAllUnique("qcor-params-energy");
     VQEEnergiesAndParameters ret;
     for (auto &ei : tmp_ei) {
@@ -214,8 +265,31 @@ public:
     return ret;
   }
 
+  // Return the evaluation history (most recent evaluations, oldest
+  // first, not de-duplicated), nullptr if not enabled
+  std::shared_ptr<OptimizationHistory> get_history() { return history; }
+
   void persist_data(const std::string& filename) {
+    if (!children_dropped()) {
       q.write_file(filename);
+      return;
+    }
+    // Rebuild the child buffers from the history entries
+    warn_if_truncated();
+    auto tmp = qalloc(q.size());
+    for (auto &entry : history->entries()) {
+      auto child = qalloc(q.size());
+      child.results()->addExtraInfo("parameters", entry.parameters);
+      auto params_energy = entry.parameters;
+      params_energy.push_back(entry.energy);
+      child.results()->addExtraInfo("qcor-params-energy", params_energy);
+      if (std::fabs(entry.stddev) > 1e-12) {
+        child.results()->addExtraInfo("qcor-energy-stddev", entry.stddev);
+      }
+      child.results()->addExtraInfo("iteration", entry.iteration);
+      tmp.addChild(child);
+    }
+    tmp.write_file(filename);
   }
 
 };
@@ -248,7 +322,7 @@ protected:
     int gamma_counter = 0;
     int beta_counter = 0;
     for (int i = 0; i < nQubits; i++) {
-      quantum::h(q[0]);
+      quantum::h(q[i]);
     }
     auto cost_ham_ptr = createObservable(cost_ham_str);
     auto &cost_ham = *cost_ham_ptr.get();
@@ -341,6 +415,15 @@ public:
   // Helper qaoa algorithm result type
   using QAOAResultType = std::pair<double, std::vector<double>>;
 
+protected:
+  // Optimize the exact QAOA energy of a diagonal (Z-only) cost hamiltonian
+  // with a direct state-vector simulation and adjoint gradients
+  // (option "diagonal-simulation"). Implemented in qcor_hybrid.cpp.
+  QAOAResultType execute_diagonal(std::shared_ptr<Optimizer> optimizer,
+                                  const std::vector<double> &init_params);
+
+public:
+
   // The Constructionr, takes the cost hamiltonian and the number of steps.
   // will assume reference hamiltonian of an X pauli on all qubits
   QAOA(PauliOperator &obs, const std::size_t _n_steps,
@@ -395,6 +478,11 @@ public:
       init_params = initial_parameters;
     }
 
+    if (options.keyExists<bool>("diagonal-simulation") &&
+        options.get<bool>("diagonal-simulation")) {
+      return execute_diagonal(optimizer, init_params);
+    }
+
     auto args_translator =
         std::make_shared<ArgsTranslator<qreg, int, std::vector<double>,
                                         std::vector<double>, std::string>>(
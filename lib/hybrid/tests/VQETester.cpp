@@ -91,6 +91,28 @@ TEST(VQE_Hybrid_Tester, checkDeuteron) {
   }
 }
 
+TEST(VQE_Hybrid_Tester, checkObserveBatch) {
+  auto H = 5.907 - 2.1433 * qcor::X(0) * qcor::X(1) -
+           2.1433 * qcor::Y(0) * qcor::Y(1) + .21829 * qcor::Z(0) -
+           6.125 * qcor::Z(1);
+  auto q = qalloc(2);
+  std::vector<std::tuple<qreg, double>> points;
+  for (auto x : qcor::linspace(-1.0, 1.0, 5)) {
+    points.emplace_back(q, x);
+  }
+  points.emplace_back(q, 0.594);
+
+  std::vector<double> variances;
+  auto energies = qcor::observe_batch(ansatz, H, points, variances);
+  EXPECT_EQ(energies.size(), points.size());
+  EXPECT_EQ(variances.size(), points.size());
+  for (int i = 0; i < points.size(); i++) {
+    auto q_single = qalloc(2);
+    const double x = std::get<1>(points[i]);
+    EXPECT_NEAR(energies[i], qcor::observe(ansatz, H, q_single, x), 1e-3);
+  }
+  EXPECT_NEAR(energies.back(), -1.7488, 1e-3);
+}
 
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,5 +1,85 @@
 #include "qcor_qsim.hpp"
+#include "pass_manager.hpp"
 #include "xacc_service.hpp"
+#include <set>
+
+namespace {
+bool containsRepeatComposite(
+    std::shared_ptr<xacc::CompositeInstruction> program) {
+  for (auto &inst : program->getInstructions()) {
+    if (qcor::qsim::isRepeatComposite(inst) ||
+        (inst->isComposite() &&
+         containsRepeatComposite(
+             std::dynamic_pointer_cast<xacc::CompositeInstruction>(inst)))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Collect the (unique) bodies of all repeat composites in the program.
+void findRepeatBodies(
+    std::shared_ptr<xacc::CompositeInstruction> program,
+    std::vector<std::shared_ptr<xacc::CompositeInstruction>> &bodies) {
+  for (auto &inst : program->getInstructions()) {
+    if (qcor::qsim::isRepeatComposite(inst)) {
+      auto body =
+          std::dynamic_pointer_cast<qcor::qsim::RepeatComposite>(inst)->body();
+      if (std::find(bodies.begin(), bodies.end(), body) == bodies.end()) {
+        bodies.emplace_back(body);
+      }
+    } else if (inst->isComposite()) {
+      findRepeatBodies(
+          std::dynamic_pointer_cast<xacc::CompositeInstruction>(inst), bodies);
+    }
+  }
+}
+
+// Run the optimization passes on the program, repeat composites are
+// barriers: the instructions in between them are optimized as separate
+// segments (the repeated bodies are optimized on their own).
+void optimizeAroundRepeats(
+    std::shared_ptr<xacc::CompositeInstruction> program,
+    std::set<xacc::CompositeInstruction *> &visited) {
+  if (!visited.insert(program.get()).second) {
+    return;
+  }
+  auto provider = xacc::getIRProvider("quantum");
+  std::vector<std::shared_ptr<xacc::Instruction>> optimizedInsts;
+  std::shared_ptr<xacc::CompositeInstruction> segment;
+  const auto flushSegment = [&]() {
+    if (segment) {
+      xacc::internal_compiler::execute_optimization_passes(segment);
+      const auto segmentInsts = segment->getInstructions();
+      optimizedInsts.insert(optimizedInsts.end(), segmentInsts.begin(),
+                            segmentInsts.end());
+      segment.reset();
+    }
+  };
+  for (auto &inst : program->getInstructions()) {
+    if (qcor::qsim::isRepeatComposite(inst)) {
+      flushSegment();
+      optimizedInsts.emplace_back(inst);
+    } else if (inst->isComposite() &&
+               containsRepeatComposite(
+                   std::dynamic_pointer_cast<xacc::CompositeInstruction>(
+                       inst))) {
+      flushSegment();
+      optimizeAroundRepeats(
+          std::dynamic_pointer_cast<xacc::CompositeInstruction>(inst), visited);
+      optimizedInsts.emplace_back(inst);
+    } else {
+      if (!segment) {
+        segment = provider->createComposite(program->name() + "__segment");
+      }
+      segment->addInstruction(inst);
+    }
+  }
+  flushSegment();
+  program->clear();
+  program->addInstructions(optimizedInsts);
+}
+} // namespace
 
 namespace qcor {
 namespace qsim {
@@ -12,8 +92,87 @@ bool CostFunctionEvaluator::initialize(Observable *observable,
 
 void executePassManager(
     std::vector<std::shared_ptr<CompositeInstruction>> evalKernels) {
+  std::vector<std::shared_ptr<CompositeInstruction>> repeatBodies;
+  for (auto &subKernel : evalKernels) {
+    findRepeatBodies(subKernel, repeatBodies);
+  }
+  if (repeatBodies.empty()) {
+    for (auto &subKernel : evalKernels) {
+      execute_pass_manager(subKernel);
+    }
+    return;
+  }
+
+  // Optimize each repeated body once rather than every repetition,
+  // then the rest of the programs around the repeated bodies.
+  for (auto &body : repeatBodies) {
+    xacc::internal_compiler::execute_optimization_passes(body);
+  }
+  std::set<CompositeInstruction *> visited;
+  for (auto &subKernel : evalKernels) {
+    optimizeAroundRepeats(subKernel, visited);
+  }
+  // The repeat composites are kept compressed (references to their body),
+  // unless a placement is applied: it transforms the programs in-place, the
+  // repetitions must then be independent copies.
+  auto qpu = xacc::internal_compiler::qpu;
+  if (!qpu || qpu->getConnectivity().empty()) {
+    return;
+  }
+  qcor::internal::PassManager placement(
+      0, xacc::internal_compiler::__qubit_map,
+      xacc::internal_compiler::__placement_name);
   for (auto &subKernel : evalKernels) {
-    execute_pass_manager(subKernel);
+    expandRepeatComposites(subKernel);
+    placement.applyPlacement(subKernel);
+  }
+}
+
+RepeatComposite::RepeatComposite(std::shared_ptr<CompositeInstruction> body,
+                                 int count)
+    : xacc::quantum::Circuit("__REPEAT__" + body->name()), m_body(body),
+      m_count(count) {
+  std::vector<std::shared_ptr<xacc::Instruction>> repetitions(count, body);
+  addInstructions(repetitions);
+}
+
+void RepeatComposite::unroll() {
+  if (m_unrolled) {
+    return;
+  }
+  std::vector<std::shared_ptr<xacc::Instruction>> repetitions{m_body};
+  for (int i = 1; i < m_count; ++i) {
+    repetitions.emplace_back(m_body->clone());
+  }
+  clear();
+  addInstructions(repetitions);
+  m_unrolled = true;
+}
+
+std::shared_ptr<CompositeInstruction>
+createRepeatComposite(std::shared_ptr<CompositeInstruction> body, int count) {
+  return std::make_shared<RepeatComposite>(body, count);
+}
+
+bool isRepeatComposite(std::shared_ptr<xacc::Instruction> inst) {
+  auto repeatComp = std::dynamic_pointer_cast<RepeatComposite>(inst);
+  return repeatComp && !repeatComp->isUnrolled();
+}
+
+int getRepeatCount(std::shared_ptr<xacc::Instruction> inst) {
+  auto repeatComp = std::dynamic_pointer_cast<RepeatComposite>(inst);
+  return repeatComp ? repeatComp->repeatCount() : 1;
+}
+
+void expandRepeatComposites(std::shared_ptr<CompositeInstruction> program) {
+  for (auto &inst : program->getInstructions()) {
+    if (isRepeatComposite(inst)) {
+      std::dynamic_pointer_cast<RepeatComposite>(inst)->unroll();
+    }
+    if (inst->isComposite()) {
+      expandRepeatComposites(
+          std::dynamic_pointer_cast<CompositeInstruction>(inst));
+    }
   }
 }
 
@@ -194,7 +194,40 @@ getObjEvaluator(PauliOperator &obs, const std::string &name = "default",
 }
 
 // Helper to apply optimization/placement before evaluation:
+// Repeated bodies (see createRepeatComposite) are optimized once and the
+// rest of the programs around them. The repeat composites are only expanded
+// if a placement is applied.
 void executePassManager(
     std::vector<std::shared_ptr<CompositeInstruction>> evalKernels);
+
+// Compact "repeat N times" composite: the body is stored once and the count
+// is kept as a member. Its N instructions are references to the same body,
+// i.e. IR consumers (accelerators, visitors) see the repeated sequence
+// without N copies of the body. Transformations that modify instructions
+// in-place (placement) need independent copies, see expandRepeatComposites.
+class RepeatComposite : public xacc::quantum::Circuit {
+public:
+  RepeatComposite(std::shared_ptr<CompositeInstruction> body, int count);
+  std::shared_ptr<CompositeInstruction> body() const { return m_body; }
+  int repeatCount() const { return m_count; }
+  bool isUnrolled() const { return m_unrolled; }
+  // Replace the body references by independent clones of the body.
+  void unroll();
+
+private:
+  std::shared_ptr<CompositeInstruction> m_body;
+  int m_count;
+  bool m_unrolled = false;
+};
+
+std::shared_ptr<CompositeInstruction>
+createRepeatComposite(std::shared_ptr<CompositeInstruction> body, int count);
+// True for a (not yet expanded) repeat composite
+bool isRepeatComposite(std::shared_ptr<xacc::Instruction> inst);
+// Repeat count of a repeat composite (1 for any other instruction)
+int getRepeatCount(std::shared_ptr<xacc::Instruction> inst);
+// Expand all repeat composites in the program, in-place, into
+// independent clones of their body.
+void expandRepeatComposites(std::shared_ptr<CompositeInstruction> program);
 } // namespace qsim
 } // namespace qcor
\ No newline at end of file
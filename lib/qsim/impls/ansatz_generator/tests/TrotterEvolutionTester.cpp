@@ -0,0 +1,92 @@
+#include "qcor.hpp"
+#include "qcor_qsim.hpp"
+#include "qcor_state_vector.hpp"
+#include "xacc.hpp"
+#include "xacc_service.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+// Energy after a single Trotter step from |00>,
+// the exact evolution conserves the initial energy (= 1.0).
+double evolvedEnergy(qcor::PauliOperator &ham, int order, bool group_terms,
+                     int &nbCnots) {
+  auto method = xacc::getService<qcor::qsim::AnsatzGenerator>("trotter");
+  auto circuit =
+      method
+          ->create_ansatz(&ham, {{"dt", 1.0},
+                                 {"order", order},
+                                 {"group-terms", group_terms}})
+          .circuit;
+  nbCnots = 0;
+  for (auto &inst : qcor::StateVector::flatten(circuit)) {
+    if (inst->name() == "CNOT") {
+      nbCnots++;
+    }
+  }
+  qcor::StateVector state(2);
+  state.apply(circuit);
+  return state.expectation(ham);
+}
+} // namespace
+
+TEST(TrotterEvolutionTester, checkSuzukiOrder) {
+  using namespace qcor;
+  auto ham = Z(0) * Z(1) + 0.5 * X(0) + 0.5 * X(1);
+  int nbCnots = 0;
+  const double err1 = std::abs(evolvedEnergy(ham, 1, false, nbCnots) - 1.0);
+  const double err2 = std::abs(evolvedEnergy(ham, 2, false, nbCnots) - 1.0);
+  const double err4 = std::abs(evolvedEnergy(ham, 4, false, nbCnots) - 1.0);
+  EXPECT_LT(err2, err1);
+  EXPECT_LT(err4, err2);
+  EXPECT_LT(err4, 0.05);
+}
+
+TEST(TrotterEvolutionTester, checkGroupTerms) {
+  using namespace qcor;
+  // Z0Z1 and Z0Z1Z2 share the leading CNOT of their ladders,
+  // X1X2 and X1 share the basis change on qubit 1.
+  auto ham = 0.7 * Z(0) * Z(1) + 0.3 * X(1) * X(2) - 0.4 * Y(0) * Z(2) +
+             0.5 * Z(0) * Z(1) * Z(2) + 0.2 * X(1);
+  auto method = xacc::getService<qsim::AnsatzGenerator>("trotter");
+  auto countCnots = [&](bool group_terms) {
+    auto circuit = method
+                       ->create_ansatz(&ham, {{"dt", 0.3},
+                                              {"order", 2},
+                                              {"group-terms", group_terms}})
+                       .circuit;
+    const auto insts = circuit->getInstructions();
+    return std::count_if(insts.begin(), insts.end(), [](auto &inst) {
+      return inst->name() == "CNOT";
+    });
+  };
+  EXPECT_LT(countCnots(true), countCnots(false));
+}
+
+TEST(TrotterEvolutionTester, checkSignConvention) {
+  using namespace qcor;
+  // <Y0> changes sign under t -> -t, the exp_i_theta (order 1) and
+  // Suzuki (order 2) circuits must evolve in the same direction.
+  auto ham = Z(0) * Z(1) + 0.5 * X(0) + 0.3 * X(1);
+  auto observable = 1.0 * Y(0);
+  auto method = xacc::getService<qsim::AnsatzGenerator>("trotter");
+  const double dt = 0.05;
+  std::vector<double> expVals;
+  for (const int order : {1, 2}) {
+    auto circuit =
+        method->create_ansatz(&ham, {{"dt", dt}, {"order", order}}).circuit;
+    StateVector state(2);
+    state.apply(circuit);
+    expVals.emplace_back(state.expectation(observable));
+  }
+  // exp(-iHt)|00>: <Y0> = -2 * 0.5 * dt + O(dt^2)
+  EXPECT_NEAR(expVals[0], -dt, 0.01);
+  EXPECT_NEAR(expVals[0], expVals[1], 0.01);
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize();
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -1,5 +1,227 @@
 #include "trotter.hpp"
+#include "xacc.hpp"
 #include "xacc_service.hpp"
+#include <algorithm>
+
+namespace {
+// A single (non-identity) Pauli term: coeff * P
+struct PauliTerm {
+  double coeff;
+  // (qubit, "X" | "Y" | "Z"), sorted by qubit index
+  std::vector<std::pair<int, std::string>> ops;
+};
+
+// Gate in the generated circuit (before conversion to xacc::Instruction)
+struct Gate {
+  std::string name;
+  std::vector<std::size_t> bits;
+  double angle = 0.0;
+};
+
+std::vector<PauliTerm> getPauliTerms(xacc::quantum::PauliOperator &pauli) {
+  std::vector<PauliTerm> terms;
+  for (auto &[termStr, term] : pauli.getTerms()) {
+    PauliTerm pauliTerm;
+    pauliTerm.coeff = term.coeff().real();
+    for (auto &[bitIdx, pauliOpStr] : term.ops()) {
+      if (pauliOpStr == "X" || pauliOpStr == "Y" || pauliOpStr == "Z") {
+        pauliTerm.ops.emplace_back(bitIdx, pauliOpStr);
+      }
+    }
+    // Identity terms only contribute a global phase.
+    if (!pauliTerm.ops.empty()) {
+      std::sort(pauliTerm.ops.begin(), pauliTerm.ops.end());
+      terms.emplace_back(pauliTerm);
+    }
+  }
+  return terms;
+}
+
+bool qubitWiseCommute(const PauliTerm &lhs, const PauliTerm &rhs) {
+  for (const auto &[bit1, op1] : lhs.ops) {
+    for (const auto &[bit2, op2] : rhs.ops) {
+      if (bit1 == bit2 && op1 != op2) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Greedily partition the terms into qubit-wise commuting groups.
+// Within a group, terms are sorted by their Pauli strings so that
+// terms sharing basis changes and leading CNOTs are adjacent.
+std::vector<PauliTerm> groupTerms(const std::vector<PauliTerm> &terms) {
+  std::vector<std::vector<PauliTerm>> groups;
+  for (const auto &term : terms) {
+    auto groupIter = std::find_if(
+        groups.begin(), groups.end(), [&](const std::vector<PauliTerm> &group) {
+          return std::all_of(group.begin(), group.end(),
+                             [&](const PauliTerm &other) {
+                               return qubitWiseCommute(term, other);
+                             });
+        });
+    if (groupIter == groups.end()) {
+      groups.push_back({term});
+    } else {
+      groupIter->emplace_back(term);
+    }
+  }
+
+  std::vector<PauliTerm> result;
+  for (auto &group : groups) {
+    std::sort(group.begin(), group.end(),
+              [](const PauliTerm &lhs, const PauliTerm &rhs) {
+                return lhs.ops < rhs.ops;
+              });
+    result.insert(result.end(), group.begin(), group.end());
+  }
+  return result;
+}
+
+// Suzuki product formula of the given order as a sequence of
+// (term index, time) exponentials, i.e. prod_k exp(-i * time_k * h_k).
+// S1(t) = prod_{j=1..m} exp(-i h_j t)
+// S2(t) = prod_{j=1..m} exp(-i h_j t/2) prod_{j=m..1} exp(-i h_j t/2)
+// S2k(t) = S2k-2(p t)^2 S2k-2((1 - 4p) t) S2k-2(p t)^2,
+// p = 1 / (4 - 4^(1/(2k-1)))
+void suzukiSequence(int order, std::size_t nbTerms, double t,
+                    std::vector<std::pair<std::size_t, double>> &sequence) {
+  if (order == 1) {
+    for (std::size_t i = 0; i < nbTerms; ++i) {
+      sequence.emplace_back(i, t);
+    }
+  } else if (order == 2) {
+    for (std::size_t i = 0; i < nbTerms; ++i) {
+      sequence.emplace_back(i, 0.5 * t);
+    }
+    for (std::size_t i = nbTerms; i-- > 0;) {
+      sequence.emplace_back(i, 0.5 * t);
+    }
+  } else {
+    const double p = 1.0 / (4.0 - std::pow(4.0, 1.0 / (order - 1)));
+    suzukiSequence(order - 2, nbTerms, p * t, sequence);
+    suzukiSequence(order - 2, nbTerms, p * t, sequence);
+    suzukiSequence(order - 2, nbTerms, (1.0 - 4.0 * p) * t, sequence);
+    suzukiSequence(order - 2, nbTerms, p * t, sequence);
+    suzukiSequence(order - 2, nbTerms, p * t, sequence);
+  }
+}
+
+bool isInverse(const Gate &lhs, const Gate &rhs) {
+  if (lhs.bits != rhs.bits) {
+    return false;
+  }
+  if (lhs.name == "CNOT" || lhs.name == "H") {
+    return lhs.name == rhs.name;
+  }
+  if (lhs.name == "Rx") {
+    return rhs.name == "Rx" && std::abs(lhs.angle + rhs.angle) < 1e-12;
+  }
+  return false;
+}
+
+// Peephole circuit builder: a gate is cancelled against (or merged with)
+// the last gate that acts on exactly the same qubits, provided no other
+// gate touches those qubits in between.
+class GateSequence {
+public:
+  void append(const Gate &gate) {
+    const auto prevIdx = lastGate(gate.bits);
+    if (prevIdx >= 0) {
+      auto &prev = gates[prevIdx];
+      if (isInverse(prev, gate)) {
+        remove(prevIdx);
+        return;
+      }
+      if (prev.name == "Rz" && gate.name == "Rz" && prev.bits == gate.bits) {
+        prev.angle += gate.angle;
+        if (std::abs(prev.angle) < 1e-12) {
+          remove(prevIdx);
+        }
+        return;
+      }
+    }
+    gates.emplace_back(gate);
+    removed.emplace_back(false);
+    for (const auto &bit : gate.bits) {
+      if (bit >= qubitStacks.size()) {
+        qubitStacks.resize(bit + 1);
+      }
+      qubitStacks[bit].emplace_back(gates.size() - 1);
+    }
+  }
+
+  std::vector<Gate> getGates() const {
+    std::vector<Gate> result;
+    for (std::size_t i = 0; i < gates.size(); ++i) {
+      if (!removed[i]) {
+        result.emplace_back(gates[i]);
+      }
+    }
+    return result;
+  }
+
+private:
+  // Index of the last gate touching exactly these qubits, -1 if none.
+  int lastGate(const std::vector<std::size_t> &bits) const {
+    int idx = -1;
+    for (const auto &bit : bits) {
+      if (bit >= qubitStacks.size() || qubitStacks[bit].empty()) {
+        return -1;
+      }
+      const int top = qubitStacks[bit].back();
+      if (idx >= 0 && top != idx) {
+        return -1;
+      }
+      idx = top;
+    }
+    return (idx >= 0 && gates[idx].bits.size() == bits.size()) ? idx : -1;
+  }
+
+  void remove(std::size_t idx) {
+    removed[idx] = true;
+    for (const auto &bit : gates[idx].bits) {
+      qubitStacks[bit].pop_back();
+    }
+  }
+
+  std::vector<Gate> gates;
+  std::vector<bool> removed;
+  // Per-qubit stack of (non-removed) gate indices
+  std::vector<std::vector<std::size_t>> qubitStacks;
+};
+
+// exp(-i * coeff * t * P): basis change, CNOT ladder, Rz, uncompute.
+void appendExponential(const PauliTerm &term, double t, GateSequence &seq) {
+  const auto &ops = term.ops;
+  for (std::size_t i = 0; i < ops.size(); ++i) {
+    const std::size_t bit = ops[i].first;
+    if (ops[i].second == "X") {
+      seq.append({"H", {bit}});
+    } else if (ops[i].second == "Y") {
+      seq.append({"Rx", {bit}, M_PI_2});
+    }
+  }
+  for (std::size_t i = 0; i + 1 < ops.size(); ++i) {
+    seq.append({"CNOT",
+                {(std::size_t)ops[i].first, (std::size_t)ops[i + 1].first}});
+  }
+  seq.append({"Rz", {(std::size_t)ops.back().first}, 2.0 * term.coeff * t});
+  for (std::size_t i = ops.size() - 1; i-- > 0;) {
+    seq.append({"CNOT",
+                {(std::size_t)ops[i].first, (std::size_t)ops[i + 1].first}});
+  }
+  for (std::size_t i = ops.size(); i-- > 0;) {
+    const std::size_t bit = ops[i].first;
+    if (ops[i].second == "X") {
+      seq.append({"H", {bit}});
+    } else if (ops[i].second == "Y") {
+      seq.append({"Rx", {bit}, -M_PI_2});
+    }
+  }
+}
+} // namespace
 
 namespace qcor {
 namespace qsim {
@@ -12,15 +234,70 @@ Ansatz TrotterEvolution::create_ansatz(Observable *obs,
   if (params.keyExists<double>("dt")) {
     dt = params.get<double>("dt");
   }
-  // Just use exp_i_theta for now
-  // TODO: formalize a standard library kernel for this.
-  auto expCirc = std::dynamic_pointer_cast<xacc::quantum::Circuit>(
-      xacc::getService<xacc::Instruction>("exp_i_theta"));
-  expCirc->expand({{"pauli", obs->toString()}});
-  result.circuit = expCirc->operator()({dt});
-  result.nb_qubits = expCirc->nRequiredBits();
+  int order = 1;
+  if (params.keyExists<int>("order")) {
+    order = params.get<int>("order");
+  }
+  if (order != 1 && (order < 2 || order % 2 != 0)) {
+    xacc::error("Invalid Trotter-Suzuki order " + std::to_string(order) +
+                ". Must be 1 or an even number.");
+  }
+  bool group_terms = false;
+  if (params.keyExists<bool>("group-terms")) {
+    group_terms = params.get<bool>("group-terms");
+  }
+
+  if (order == 1 && !group_terms) {
+    // Just use exp_i_theta for now
+    // TODO: formalize a standard library kernel for this.
+    auto expCirc = std::dynamic_pointer_cast<xacc::quantum::Circuit>(
+        xacc::getService<xacc::Instruction>("exp_i_theta"));
+    expCirc->expand({{"pauli", obs->toString()}});
+    result.circuit = expCirc->operator()({dt});
+    result.nb_qubits = expCirc->nRequiredBits();
+    return result;
+  }
 
+  auto pauli = dynamic_cast<xacc::quantum::PauliOperator *>(obs);
+  if (!pauli) {
+    xacc::error("Higher-order Trotter evolution requires a Pauli observable.");
+  }
+  auto terms = getPauliTerms(*pauli);
+  if (group_terms) {
+    terms = groupTerms(terms);
+  }
+
+  std::vector<std::pair<std::size_t, double>> sequence;
+  suzukiSequence(order, terms.size(), dt, sequence);
+  GateSequence gates;
+  for (std::size_t i = 0; i < sequence.size(); ++i) {
+    // Merge consecutive exponentials of the same term,
+    // e.g. at the center of S2 and between S2 blocks.
+    double t = sequence[i].second;
+    while (i + 1 < sequence.size() &&
+           sequence[i + 1].first == sequence[i].first) {
+      t += sequence[++i].second;
+    }
+    appendExponential(terms[sequence[i].first], t, gates);
+  }
+
+  auto provider = xacc::getIRProvider("quantum");
+  result.circuit = provider->createComposite("__TROTTER_SUZUKI__");
+  size_t nbQubits = 0;
+  for (const auto &gate : gates.getGates()) {
+    for (const auto &bit : gate.bits) {
+      nbQubits = std::max(nbQubits, bit + 1);
+    }
+    if (gate.name == "Rz" || gate.name == "Rx") {
+      result.circuit->addInstruction(
+          provider->createInstruction(gate.name, gate.bits, {gate.angle}));
+    } else {
+      result.circuit->addInstruction(
+          provider->createInstruction(gate.name, gate.bits));
+    }
+  }
+  result.nb_qubits = nbQubits;
   return result;
 }
 } // namespace qsim
-} // namespace qcor
\ No newline at end of file
+} // namespace qcor
@@ -3,7 +3,13 @@
 
 namespace qcor {
 namespace qsim {
-// 1st-order Trotterization
+// Trotter-Suzuki evolution: exp(-iHt)
+// Params:
+// - "dt": evolution time (default 1.0)
+// - "order": Suzuki order, 1 or any even number (default 1).
+// - "group-terms": group qubit-wise commuting terms and order them so that
+// basis changes and CNOT ladders of consecutive exponentials cancel
+// (default false).
 class TrotterEvolution : public AnsatzGenerator {
 public:
   Ansatz create_ansatz(Observable *obs,
@@ -12,4 +18,4 @@ public:
   virtual const std::string description() const override { return ""; }
 };
 } // namespace qsim
-} // namespace qcor
\ No newline at end of file
+} // namespace qcor
@@ -38,6 +38,19 @@ double PhaseEstimationObjFuncEval::evaluate(
   if (hyperParams.keyExists<bool>("verified")) {
     verifyMode = hyperParams.get<bool>("verified");
   }
+
+  // Noise-free local simulation: simulate the common prefixes of all the
+  // kernels (e.g. state_prep) only once (not applicable in verify mode).
+  bool sharedPrefix = false;
+  if (hyperParams.keyExists<bool>("shared-prefix")) {
+    sharedPrefix = hyperParams.get<bool>("shared-prefix");
+  }
+
+  // Spectral estimation method: "prony" or "matrix-pencil"
+  std::string spectralMethod = "prony";
+  if (hyperParams.stringExists("spectral-method")) {
+    spectralMethod = hyperParams.getString("spectral-method");
+  }
   // Minimum: 2 freqs (eigenvalues) -> 5 data points.
   if (nbSteps < 5) {
     xacc::error("Not enough time-series data samples for frequency/eigenvalue "
@@ -159,13 +172,21 @@ double PhaseEstimationObjFuncEval::evaluate(
     obsTermTracking.emplace_back(std::make_pair(termCoeff, termData));
   }
 
-  auto temp_buffer = xacc::qalloc(nbQubits + 1);
-  // Execute all sub-kernels
-  executePassManager(fsToExec);
-  xacc::internal_compiler::execute(temp_buffer.get(), fsToExec);
-
   // Assemble execution data into a fast look-up map
   ExecutionData exeResult;
+  const auto localExpVals = (sharedPrefix && !verifyMode)
+                                ? evaluateSharedPrefix(fsToExec)
+                                : std::vector<double>{};
+  for (size_t i = 0; i < localExpVals.size(); ++i) {
+    exeResult.emplace(fsToExec[i]->name(), localExpVals[i]);
+  }
+
+  auto temp_buffer = xacc::qalloc(nbQubits + 1);
+  if (localExpVals.empty()) {
+    // Execute all sub-kernels
+    executePassManager(fsToExec);
+    xacc::internal_compiler::execute(temp_buffer.get(), fsToExec);
+  }
 
   /// Handle rejection sampling if need verification/noise mitigation.
   // i.e. cannot rely on the default getExpectationValueZ but must manually
@@ -245,8 +266,9 @@ double PhaseEstimationObjFuncEval::evaluate(
           ? target_operator->getIdentitySubTerm()->coefficient()
           : 0.0;
 
+  // g(t) function (for each term)
+  std::vector<std::vector<std::complex<double>>> gFuncLists;
   for (const auto &[coeff, listKernels] : obsTermTracking) {
-    // g(t) function (for each term)
     std::vector<std::complex<double>> gFuncList;
     constexpr std::complex<double> I(0.0, 1.0);
 
@@ -264,12 +286,19 @@ double PhaseEstimationObjFuncEval::evaluate(
       gFuncList.emplace_back(exp_x_val + I * exp_y_val);
     }
     assert(gFuncList.size() == tList.size());
-    /// (II) Fit g(t) to determine A0 and A1
     /// DEBUG:
     // for (size_t i = 0; i < gFuncList.size(); ++i) {
     //   std::cout << "t = " << tList[i] << ": " << gFuncList[i] << "\n";
     // }
-    const auto pronyRaw = qcor::qsim::pronyFit(gFuncList);
+    gFuncLists.emplace_back(std::move(gFuncList));
+  }
+
+  /// (II) Fit g(t) to determine A0 and A1 (all terms at once)
+  const auto spectralResults =
+      qcor::qsim::spectralFit(gFuncLists, spectralMethod);
+  for (size_t termIdx = 0; termIdx < obsTermTracking.size(); ++termIdx) {
+    const auto &coeff = obsTermTracking[termIdx].first;
+    const auto &pronyRaw = spectralResults[termIdx];
     qcor::qsim::PronyResult pronyFit;
     // Filter the frequency around the 1-circle:
     // Some noise channels on the control qubit will introduce spurious
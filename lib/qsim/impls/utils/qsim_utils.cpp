@@ -1,8 +1,165 @@
 #include "qsim_utils.hpp"
+#include "qcor_state_vector.hpp"
+#include "xacc_service.hpp"
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
 #include <Eigen/QR>
+#include <Eigen/SVD>
 #include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace {
+using InstPtr = std::shared_ptr<xacc::Instruction>;
+
+// Exact (full-precision) identification key of an instruction.
+std::string instructionKey(const InstPtr &in_inst) {
+  std::stringstream ss;
+  ss << in_inst->name();
+  for (const auto &bit : in_inst->bits()) {
+    ss << " " << bit;
+  }
+  ss << std::hexfloat;
+  for (int i = 0; i < in_inst->nParameters(); ++i) {
+    ss << " " << xacc::InstructionParameterToDouble(in_inst->getParameter(i));
+  }
+  return ss.str();
+}
+
+struct PrefixTreeData {
+  std::vector<std::vector<InstPtr>> insts;
+  std::vector<std::vector<std::string>> keys;
+  // Bit-mask of the measured qubits for each kernel
+  std::vector<size_t> measureMasks;
+  std::vector<double> results;
+};
+
+// H(i, j) = s(offset + i + j)
+Eigen::MatrixXcd hankelMatrix(const std::vector<std::complex<double>> &in_signal,
+                              size_t in_offset, size_t in_rows,
+                              size_t in_cols) {
+  Eigen::MatrixXcd result(in_rows, in_cols);
+  for (size_t j = 0; j < in_cols; ++j) {
+    result.col(j) = Eigen::Map<const Eigen::VectorXcd>(
+        in_signal.data() + in_offset + j, in_rows);
+  }
+  return result;
+}
+
+// Least-squares amplitudes for the given poles:
+// s(i) = sum_j a_j * z_j^i
+qcor::qsim::PronyResult
+fitAmplitudes(const std::vector<std::complex<double>> &in_signal,
+              const Eigen::VectorXcd &in_phases) {
+  Eigen::MatrixXcd generation_matrix(in_signal.size(), in_phases.size());
+  for (int j = 0; j < generation_matrix.cols(); ++j) {
+    std::complex<double> power = 1.0;
+    for (int i = 0; i < generation_matrix.rows(); ++i) {
+      generation_matrix(i, j) = power;
+      power *= in_phases[j];
+    }
+  }
+
+  const Eigen::VectorXcd signal =
+      Eigen::Map<const Eigen::VectorXcd>(in_signal.data(), in_signal.size());
+  const Eigen::VectorXcd amplitudes =
+      generation_matrix.fullPivHouseholderQr().solve(signal);
+  // std::cout << "Amplitude:\n" << amplitudes << "\n";
+  // std::cout << "Phases:\n" << in_phases << "\n";
+  qcor::qsim::PronyResult finalResult;
+  for (int i = 0; i < in_phases.size(); ++i) {
+    finalResult.emplace_back(std::make_pair(amplitudes(i), in_phases(i)));
+  }
+
+  // Sort by amplitude:
+  std::sort(finalResult.begin(), finalResult.end(),
+            [](const auto &a, const auto &b) {
+              return std::abs(a.first) < std::abs(b.first);
+            });
+  return finalResult;
+}
+
+// <Z...Z> on the measured qubits
+double parityExpectation(const qcor::StateVector &in_state, size_t in_mask) {
+  double result = 0.0;
+  const auto &amplitudes = in_state.amplitudes();
+  for (size_t i = 0; i < (size_t)amplitudes.size(); ++i) {
+    const double prob = std::norm(amplitudes[i]);
+    result += (__builtin_popcountll(i & in_mask) % 2) ? -prob : prob;
+  }
+  return result;
+}
+
+// Simulates the sub-tree of kernels (which share the first 'in_depth'
+// instructions) from the given state.
+void evaluatePrefixTree(PrefixTreeData &io_data, std::vector<size_t> in_ids,
+                        size_t in_depth, qcor::StateVector &io_state) {
+  for (;;) {
+    // Kernels that are completed at this depth
+    std::vector<size_t> remaining;
+    for (const auto &id : in_ids) {
+      if (io_data.insts[id].size() == in_depth) {
+        io_data.results[id] =
+            parityExpectation(io_state, io_data.measureMasks[id]);
+      } else {
+        remaining.emplace_back(id);
+      }
+    }
+    if (remaining.empty()) {
+      return;
+    }
+
+    // Group by the next instruction
+    std::map<std::string, std::vector<size_t>> branches;
+    for (const auto &id : remaining) {
+      branches[io_data.keys[id][in_depth]].emplace_back(id);
+    }
+    // Branch out from a copy of the current state,
+    // the last branch continues with the current state.
+    auto lastBranch = std::prev(branches.end());
+    for (auto it = branches.begin(); it != lastBranch; ++it) {
+      qcor::StateVector branchState = io_state;
+      branchState.apply(io_data.insts[it->second.front()][in_depth]);
+      evaluatePrefixTree(io_data, it->second, in_depth + 1, branchState);
+    }
+    io_state.apply(io_data.insts[lastBranch->second.front()][in_depth]);
+    in_ids = lastBranch->second;
+    ++in_depth;
+  }
+}
+// Flattened (enabled) gates of the kernel, the body of repeat composites
+// (see createRepeatComposite) is flattened once.
+void flattenKernel(const std::shared_ptr<xacc::CompositeInstruction> &in_kernel,
+                   std::vector<InstPtr> &io_insts) {
+  for (auto &inst : in_kernel->getInstructions()) {
+    if (!inst->isComposite()) {
+      if (inst->isEnabled()) {
+        io_insts.emplace_back(inst);
+      }
+    } else if (qcor::qsim::isRepeatComposite(inst)) {
+      auto repeatComp =
+          std::dynamic_pointer_cast<qcor::qsim::RepeatComposite>(inst);
+      std::vector<InstPtr> body;
+      flattenKernel(repeatComp->body(), body);
+      for (int i = 0; i < repeatComp->repeatCount(); ++i) {
+        io_insts.insert(io_insts.end(), body.begin(), body.end());
+      }
+    } else {
+      flattenKernel(std::dynamic_pointer_cast<xacc::CompositeInstruction>(inst),
+                    io_insts);
+    }
+  }
+}
+} // namespace
+
 namespace qcor {
 namespace qsim {
 std::shared_ptr<CostFunctionEvaluator>
@@ -25,91 +182,455 @@ getEvaluator(Observable *observable, const HeterogeneousMap &params) {
 
 PronyResult pronyFit(const std::vector<std::complex<double>> &in_signal) {
   assert(!in_signal.empty());
+  const size_t num_freqs = in_signal.size() / 2;
+  const size_t num_cols = in_signal.size() - num_freqs;
+  // Transposed Hankel matrices H0(i, j) = s(i + j), H1(i, j) = s(i + j + 1)
+  const Eigen::MatrixXcd hankel0 =
+      hankelMatrix(in_signal, 0, num_freqs, num_cols).transpose();
+  const Eigen::MatrixXcd hankel1 =
+      hankelMatrix(in_signal, 1, num_freqs, num_cols).transpose();
+  // Single factorization, all columns of the shift matrix at once.
+  Eigen::MatrixXcd shift_matrix =
+      hankel0.fullPivHouseholderQr().solve(hankel1).transpose();
+  // std::cout << "Shift matrix: \n" << shift_matrix << "\n";
 
-  // Returns the Hankel matrix constructed from the first column c, and
-  // (optionally) the last row r.
-  auto hankelMat =
-      [](const std::vector<std::complex<double>> &c,
-         const std::vector<std::complex<double>> &r) -> Eigen::MatrixXcd {
-    Eigen::MatrixXcd result = Eigen::MatrixXcd::Zero(c.size(), r.size());
-    const auto m = c.size();
-    for (int i = 0; i < result.rows(); ++i) {
-      for (int j = 0; j < result.cols(); ++j) {
-        // H(i,j) = c(i+j),  i+j < m;
-        if (i + j < m) {
-          result(i, j) = c[i + j];
-        } else {
-          // H(i,j) = r(i+j+1-m),  otherwise
-          result(i, j) = r[i + j + 1 - m];
-        }
-      }
+  Eigen::ComplexEigenSolver<Eigen::MatrixXcd> s(shift_matrix,
+                                                /*computeEigenvectors*/ false);
+  return fitAmplitudes(in_signal, s.eigenvalues());
+}
+
+PronyResult matrixPencilFit(const std::vector<std::complex<double>> &in_signal,
+                            size_t in_numFreqs, double in_svdThreshold) {
+  assert(!in_signal.empty());
+  // Pencil parameter L = N/2, Y(i, j) = s(i + j), (N - L) x (L + 1)
+  const size_t pencil_param = in_signal.size() / 2;
+  const Eigen::MatrixXcd hankel = hankelMatrix(
+      in_signal, 0, in_signal.size() - pencil_param, pencil_param + 1);
+  Eigen::JacobiSVD<Eigen::MatrixXcd> svd(hankel, Eigen::ComputeThinV);
+  const auto &singular_values = svd.singularValues();
+
+  // Signal subspace: either the requested number of frequencies or all
+  // singular values above the (relative) noise threshold.
+  size_t num_freqs = in_numFreqs;
+  if (num_freqs == 0) {
+    while (num_freqs < (size_t)singular_values.size() &&
+           singular_values(num_freqs) > in_svdThreshold * singular_values(0)) {
+      ++num_freqs;
     }
+  }
+  num_freqs = std::max<size_t>(
+      1, std::min<size_t>(num_freqs, singular_values.size()));
 
-    return result;
+  // Y1 = Y(:, 0:L-1) = U S V1^H, Y2 = Y(:, 1:L) = U S V2^H
+  // The poles are the eigenvalues of (V2^H) (V1^H)^+ = (V1^+ V2)^H
+  const Eigen::MatrixXcd signal_space = svd.matrixV().leftCols(num_freqs);
+  const Eigen::MatrixXcd v1 = signal_space.topRows(pencil_param);
+  const Eigen::MatrixXcd v2 = signal_space.bottomRows(pencil_param);
+  const Eigen::MatrixXcd pencil = v1.completeOrthogonalDecomposition().solve(v2);
+  Eigen::ComplexEigenSolver<Eigen::MatrixXcd> s(pencil,
+                                                /*computeEigenvectors*/ false);
+  return fitAmplitudes(in_signal, s.eigenvalues().conjugate());
+}
+
+std::vector<PronyResult> spectralFit(
+    const std::vector<std::vector<std::complex<double>>> &in_signals,
+    const std::string &in_method) {
+  if (in_method != "prony" && in_method != "matrix-pencil") {
+    xacc::error("Unknown spectral estimation method '" + in_method + "'.");
+  }
+  const auto fitSignal = [&](size_t idx) {
+    return (in_method == "prony") ? pronyFit(in_signals[idx])
+                                  : matrixPencilFit(in_signals[idx]);
   };
 
-  // Pythonic vector slice:
-  auto vectorSlice = [](const std::vector<std::complex<double>> &in_vec,
-                        int in_start, int in_end) {
-    std::vector<std::complex<double>> result;
-    auto startIter = in_vec.begin() + in_start;
-    auto endIter =
-        in_end > 0 ? in_vec.begin() + in_end : (in_vec.end() + in_end);
-    result.assign(startIter, endIter);
-    return result;
+  // Signals are independent: split them into contiguous chunks,
+  // one asynchronous task per chunk.
+  std::vector<PronyResult> results(in_signals.size());
+  const size_t nbTasks = std::min<size_t>(
+      in_signals.size(), std::max(1u, std::thread::hardware_concurrency()));
+  if (nbTasks <= 1) {
+    for (size_t i = 0; i < in_signals.size(); ++i) {
+      results[i] = fitSignal(i);
+    }
+    return results;
+  }
+
+  const size_t chunkSize = (in_signals.size() + nbTasks - 1) / nbTasks;
+  std::vector<std::future<void>> tasks;
+  for (size_t begin = 0; begin < in_signals.size(); begin += chunkSize) {
+    const size_t end = std::min(begin + chunkSize, in_signals.size());
+    tasks.emplace_back(std::async(std::launch::async, [&, begin, end]() {
+      for (size_t i = begin; i < end; ++i) {
+        results[i] = fitSignal(i);
+      }
+    }));
+  }
+  for (auto &task : tasks) {
+    task.get();
+  }
+  return results;
+}
+
+std::vector<double> evaluateSharedPrefix(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &in_kernels) {
+  PrefixTreeData data;
+  size_t nbQubits = 1;
+  for (const auto &kernel : in_kernels) {
+    std::vector<InstPtr> insts;
+    flattenKernel(kernel, insts);
+    std::vector<std::string> keys;
+    size_t measureMask = 0;
+    for (const auto &inst : insts) {
+      if (!StateVector::is_supported(inst)) {
+        return {};
+      }
+      if (inst->name() == "Measure") {
+        measureMask |= 1ULL << inst->bits()[0];
+      }
+      keys.emplace_back(instructionKey(inst));
+      for (auto bit : inst->bits()) {
+        nbQubits = std::max<size_t>(nbQubits, bit + 1);
+      }
+    }
+    data.insts.emplace_back(std::move(insts));
+    data.keys.emplace_back(std::move(keys));
+    data.measureMasks.emplace_back(measureMask);
+  }
+
+  data.results.resize(in_kernels.size(), 1.0);
+  std::vector<size_t> ids(in_kernels.size());
+  std::iota(ids.begin(), ids.end(), 0);
+  StateVector state(nbQubits);
+  evaluatePrefixTree(data, ids, 0, state);
+  return data.results;
+}
+
+std::vector<OptimizationTrajectory>
+multiStartOptimize(std::shared_ptr<Optimizer> in_optimizer, size_t in_nbParams,
+                   const ObjectiveFactory &in_objectiveFactory,
+                   const HeterogeneousMap &in_params) {
+  int nbStarts = 1;
+  if (in_params.keyExists<int>("starts")) {
+    nbStarts = in_params.get<int>("starts");
+  }
+  if (nbStarts < 1) {
+    xacc::error("Invalid number of starts: " + std::to_string(nbStarts));
+  }
+  bool parallel = false;
+  if (in_params.keyExists<bool>("parallel")) {
+    parallel = in_params.get<bool>("parallel");
+  }
+  double initRange = 1.0;
+  if (in_params.keyExists<double>("init-range")) {
+    initRange = in_params.get<double>("init-range");
+  }
+  int pruneAfter = 0;
+  if (in_params.keyExists<int>("prune-after")) {
+    pruneAfter = in_params.get<int>("prune-after");
+  }
+  double pruneTolerance = 0.1;
+  if (in_params.keyExists<double>("prune-tolerance")) {
+    pruneTolerance = in_params.get<double>("prune-tolerance");
+  }
+
+  std::vector<OptimizationTrajectory> runs(nbStarts);
+  for (int i = 0; i < nbStarts; ++i) {
+    std::mt19937 engine(in_params.keyExists<int>("seed")
+                            ? in_params.get<int>("seed") + i
+                            : std::random_device()());
+    std::uniform_real_distribution<double> dist(-initRange, initRange);
+    runs[i].initial_params.resize(in_nbParams);
+    for (auto &val : runs[i].initial_params) {
+      val = dist(engine);
+    }
+  }
+
+  // Each concurrent run needs its own optimizer instance, i.e. the optimizer
+  // plugin must not be a shared service (non-cloneable or contributed). The
+  // check is done before creating any instance: creating an optimizer from a
+  // shared service would reconfigure in_optimizer itself.
+  std::vector<std::shared_ptr<Optimizer>> optimizers(nbStarts, in_optimizer);
+  if (parallel && nbStarts > 1) {
+    const auto optimizerName = in_optimizer->name();
+    bool shared = true;
+    if (xacc::hasService<Optimizer>(optimizerName)) {
+      auto first = xacc::getService<Optimizer>(optimizerName, false);
+      auto second = xacc::getService<Optimizer>(optimizerName, false);
+      shared = !first || first == second || first == in_optimizer;
+    }
+    if (shared) {
+      xacc::warning("Optimizer '" + optimizerName +
+                    "' is a shared instance. Running starts sequentially.");
+      parallel = false;
+    } else {
+      HeterogeneousMap optimizerOptions;
+      if (in_params.keyExists<HeterogeneousMap>("optimizer-options")) {
+        optimizerOptions =
+            in_params.get<HeterogeneousMap>("optimizer-options");
+      }
+      for (auto &optimizer : optimizers) {
+        optimizer =
+            createOptimizer(optimizerName, HeterogeneousMap(optimizerOptions));
+      }
+    }
+  }
+
+  std::mutex bestMutex;
+  double globalBest = std::numeric_limits<double>::max();
+  const auto runOptimization = [&](size_t idx) {
+    auto &run = runs[idx];
+    auto objective = in_objectiveFactory(idx);
+    double runBest = std::numeric_limits<double>::max();
+    std::vector<double> runBestParams;
+    OptFunction f(
+        [&](const std::vector<double> &x, std::vector<double> &dx) {
+          // Pruned: constant objective (zero gradient) to terminate the
+          // optimizer as quickly as possible.
+          if (run.pruned) {
+            std::fill(dx.begin(), dx.end(), 0.0);
+            return runBest;
+          }
+          const double energy = objective(x, dx);
+          run.energies.emplace_back(energy);
+          if (energy < runBest) {
+            runBest = energy;
+            runBestParams = x;
+          }
+          std::lock_guard<std::mutex> lock(bestMutex);
+          globalBest = std::min(globalBest, energy);
+          if (pruneAfter > 0 && run.energies.size() >= (size_t)pruneAfter &&
+              runBest > globalBest + pruneTolerance) {
+            run.pruned = true;
+          }
+          return energy;
+        },
+        in_nbParams);
+    optimizers[idx]->appendOption("initial-parameters", run.initial_params);
+    auto result = optimizers[idx]->optimize(f);
+    // Report the best evaluated point: pruned runs (and some optimizers)
+    // don't return it.
+    if (runBestParams.empty() || result.first < runBest) {
+      run.energy = result.first;
+      run.opt_params = result.second;
+    } else {
+      run.energy = runBest;
+      run.opt_params = runBestParams;
+    }
   };
 
-  const size_t num_freqs = in_signal.size() / 2;
-  auto hankel0 = hankelMat(vectorSlice(in_signal, 0, num_freqs),
-                           vectorSlice(in_signal, num_freqs - 1, -1));
-  auto hankel1 = hankelMat(vectorSlice(in_signal, 1, num_freqs + 1),
-                           vectorSlice(in_signal, num_freqs, 0));
-  // std::cout << "Hankel Matrix 0: \n" << hankel0 << "\n";
-  // std::cout << "Hankel Matrix 1: \n" << hankel1 << "\n";
-
-  hankel0.transposeInPlace();
-  hankel1.transposeInPlace();
-  Eigen::MatrixXcd shift_matrix =
-      Eigen::MatrixXcd::Zero(hankel0.cols(), hankel1.cols());
+  if (!parallel || nbStarts == 1) {
+    for (int i = 0; i < nbStarts; ++i) {
+      runOptimization(i);
+    }
+    return runs;
+  }
 
-  for (size_t i = 0; i < hankel1.cols(); ++i) {
-    Eigen::VectorXcd shift_matrix_col =
-        hankel0.fullPivHouseholderQr().solve(hankel1.col(i));
-    shift_matrix.col(i) = shift_matrix_col;
+  std::vector<std::future<void>> tasks;
+  for (int i = 0; i < nbStarts; ++i) {
+    tasks.emplace_back(
+        std::async(std::launch::async, [&, i]() { runOptimization(i); }));
   }
-  // std::cout << "Shift matrix: \n" << shift_matrix << "\n";
+  for (auto &task : tasks) {
+    task.get();
+  }
+  return runs;
+}
 
-  shift_matrix.transposeInPlace();
-  Eigen::ComplexEigenSolver<Eigen::MatrixXcd> s(shift_matrix);
-  auto phases = s.eigenvalues();
-  Eigen::MatrixXcd generation_matrix =
-      Eigen::MatrixXcd::Zero(in_signal.size(), phases.size());
-  for (int i = 0; i < generation_matrix.rows(); ++i) {
-    for (int j = 0; j < generation_matrix.cols(); ++j) {
-      generation_matrix(i, j) = std::pow(phases[j], i);
+QuantumSimulationResult
+multiStartResult(const std::vector<OptimizationTrajectory> &in_runs) {
+  assert(!in_runs.empty());
+  const auto best = std::min_element(
+      in_runs.begin(), in_runs.end(),
+      [](const OptimizationTrajectory &lhs, const OptimizationTrajectory &rhs) {
+        return lhs.energy < rhs.energy;
+      });
+  QuantumSimulationResult result{{"energy", best->energy},
+                                 {"opt-params", best->opt_params}};
+  if (in_runs.size() > 1) {
+    std::vector<double> energies;
+    std::vector<std::vector<double>> optParams, initParams, trajectories;
+    std::vector<int> pruned;
+    for (const auto &run : in_runs) {
+      energies.emplace_back(run.energy);
+      optParams.emplace_back(run.opt_params);
+      initParams.emplace_back(run.initial_params);
+      trajectories.emplace_back(run.energies);
+      pruned.emplace_back(run.pruned);
     }
+    result.insert("energies", energies);
+    result.insert("opt-params-list", optParams);
+    result.insert("initial-params-list", initParams);
+    result.insert("trajectories", trajectories);
+    result.insert("pruned", pruned);
   }
+  return result;
+}
 
-  auto signalData = in_signal;
-  Eigen::VectorXcd signal =
-      Eigen::Map<Eigen::VectorXcd>(signalData.data(), signalData.size());
-  Eigen::VectorXcd amplitudes =
-      generation_matrix.fullPivHouseholderQr().solve(signal);
-  assert(phases.size() == amplitudes.size());
-  // std::cout << "Amplitude:\n" << amplitudes << "\n";
-  // std::cout << "Phases:\n" << phases << "\n";
-  PronyResult finalResult;
-  for (size_t i = 0; i < phases.size(); ++i) {
-    finalResult.emplace_back(std::make_pair(amplitudes(i), phases(i)));
+namespace {
+const char CHECKPOINT_MAGIC[8] = {'Q', 'C', 'O', 'R', 'C', 'K', 'P', 'T'};
+const uint32_t CHECKPOINT_VERSION = 1;
+
+void writeSize(std::ostream &out, uint64_t in_size) {
+  out.write(reinterpret_cast<const char *>(&in_size), sizeof(in_size));
+}
+
+void writeString(std::ostream &out, const std::string &in_str) {
+  writeSize(out, in_str.size());
+  out.write(in_str.data(), in_str.size());
+}
+
+uint64_t readSize(std::istream &in) {
+  uint64_t size = 0;
+  in.read(reinterpret_cast<char *>(&size), sizeof(size));
+  if (!in) {
+    xacc::error("Corrupted workflow checkpoint file.");
   }
+  return size;
+}
 
-  // Sort by amplitude:
-  std::sort(finalResult.begin(), finalResult.end(),
-            [](const auto &a, const auto &b) {
-              return std::abs(a.first) < std::abs(b.first);
-            });
+std::string readString(std::istream &in) {
+  std::string str(readSize(in), '\0');
+  in.read(&str[0], str.size());
+  if (!in) {
+    xacc::error("Corrupted workflow checkpoint file.");
+  }
+  return str;
+}
+} // namespace
 
-  return finalResult;
+void WorkflowCheckpoint::setValues(const std::string &in_key,
+                                   const std::vector<double> &in_vals) {
+  m_values[in_key] = in_vals;
+}
+
+void WorkflowCheckpoint::setStrings(const std::string &in_key,
+                                    const std::vector<std::string> &in_vals) {
+  m_strings[in_key] = in_vals;
+}
+
+bool WorkflowCheckpoint::hasValues(const std::string &in_key) const {
+  return m_values.find(in_key) != m_values.end();
+}
+
+bool WorkflowCheckpoint::hasStrings(const std::string &in_key) const {
+  return m_strings.find(in_key) != m_strings.end();
+}
+
+const std::vector<double> &
+WorkflowCheckpoint::getValues(const std::string &in_key) const {
+  auto iter = m_values.find(in_key);
+  if (iter == m_values.end()) {
+    xacc::error("Workflow checkpoint has no '" + in_key + "' entry.");
+  }
+  return iter->second;
+}
+
+const std::vector<std::string> &
+WorkflowCheckpoint::getStrings(const std::string &in_key) const {
+  auto iter = m_strings.find(in_key);
+  if (iter == m_strings.end()) {
+    xacc::error("Workflow checkpoint has no '" + in_key + "' entry.");
+  }
+  return iter->second;
+}
+
+void WorkflowCheckpoint::save(const std::string &in_fileName) const {
+  const std::string tmpFileName = in_fileName + ".tmp";
+  {
+    std::ofstream out(tmpFileName, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      xacc::error("Cannot write workflow checkpoint file " + tmpFileName);
+    }
+    out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    out.write(reinterpret_cast<const char *>(&CHECKPOINT_VERSION),
+              sizeof(CHECKPOINT_VERSION));
+    writeString(out, m_workflow);
+    writeSize(out, m_values.size());
+    for (const auto &[key, vals] : m_values) {
+      writeString(out, key);
+      writeSize(out, vals.size());
+      out.write(reinterpret_cast<const char *>(vals.data()),
+                vals.size() * sizeof(double));
+    }
+    writeSize(out, m_strings.size());
+    for (const auto &[key, vals] : m_strings) {
+      writeString(out, key);
+      writeSize(out, vals.size());
+      for (const auto &str : vals) {
+        writeString(out, str);
+      }
+    }
+    out.flush();
+    if (!out) {
+      xacc::error("Failed to write workflow checkpoint file " + tmpFileName);
+    }
+  }
+  if (std::rename(tmpFileName.c_str(), in_fileName.c_str()) != 0) {
+    xacc::error("Failed to write workflow checkpoint file " + in_fileName);
+  }
+}
+
+WorkflowCheckpoint WorkflowCheckpoint::load(const std::string &in_fileName,
+                                            const std::string &in_workflow) {
+  std::ifstream in(in_fileName, std::ios::binary);
+  if (!in) {
+    xacc::error("Cannot open workflow checkpoint file " + in_fileName);
+  }
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  uint32_t version = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  if (!in || !std::equal(magic, magic + sizeof(magic), CHECKPOINT_MAGIC) ||
+      version != CHECKPOINT_VERSION) {
+    xacc::error(in_fileName + " is not a valid workflow checkpoint file.");
+  }
+
+  WorkflowCheckpoint checkpoint(readString(in));
+  if (checkpoint.workflow() != in_workflow) {
+    xacc::error("Checkpoint " + in_fileName + " was written by the '" +
+                checkpoint.workflow() + "' workflow, cannot resume '" +
+                in_workflow + "'.");
+  }
+  const auto nbValues = readSize(in);
+  for (uint64_t i = 0; i < nbValues; ++i) {
+    const auto key = readString(in);
+    std::vector<double> vals(readSize(in));
+    in.read(reinterpret_cast<char *>(vals.data()),
+            vals.size() * sizeof(double));
+    if (!in) {
+      xacc::error("Corrupted workflow checkpoint file " + in_fileName);
+    }
+    checkpoint.setValues(key, vals);
+  }
+  const auto nbStrings = readSize(in);
+  for (uint64_t i = 0; i < nbStrings; ++i) {
+    const auto key = readString(in);
+    std::vector<std::string> vals(readSize(in));
+    for (auto &str : vals) {
+      str = readString(in);
+    }
+    checkpoint.setStrings(key, vals);
+  }
+  return checkpoint;
+}
+
+CheckpointOptions
+CheckpointOptions::fromParams(const HeterogeneousMap &in_params) {
+  CheckpointOptions options;
+  if (in_params.stringExists("checkpoint")) {
+    options.file = in_params.getString("checkpoint");
+  }
+  if (in_params.keyExists<int>("checkpoint-interval")) {
+    options.interval = in_params.get<int>("checkpoint-interval");
+    if (options.interval < 1) {
+      xacc::error("Invalid checkpoint interval: " +
+                  std::to_string(options.interval));
+    }
+  }
+  if (in_params.stringExists("resume-from")) {
+    options.resume_from = in_params.getString("resume-from");
+  }
+  return options;
 }
 } // namespace qsim
-} // namespace qcor
\ No newline at end of file
+} // namespace qcor
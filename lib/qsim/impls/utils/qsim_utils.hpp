@@ -1,5 +1,6 @@
 #pragma once
 #include "qcor_qsim.hpp"
+#include <map>
 
 namespace qcor {
 namespace qsim {
@@ -13,5 +14,120 @@ getEvaluator(Observable *observable, const HeterogeneousMap &params);
 using PronyResult =
     std::vector<std::pair<std::complex<double>, std::complex<double>>>;
 PronyResult pronyFit(const std::vector<std::complex<double>> &in_signal);
+
+// Matrix-pencil method: more noise-robust alternative to pronyFit.
+// The number of frequencies is either given (in_numFreqs > 0) or determined
+// by the singular values above in_svdThreshold (relative to the largest one).
+PronyResult matrixPencilFit(const std::vector<std::complex<double>> &in_signal,
+                            size_t in_numFreqs = 0,
+                            double in_svdThreshold = 1e-3);
+
+// Fit a batch of independent signals concurrently.
+// Method: "prony" or "matrix-pencil"
+std::vector<PronyResult>
+spectralFit(const std::vector<std::vector<std::complex<double>>> &in_signals,
+            const std::string &in_method = "prony");
+
+// Evaluate a batch of kernels by local (noise-free) state-vector simulation.
+// Kernels are arranged in a prefix tree of their (flattened, with repeat
+// composites unrolled) instructions,
+// each distinct prefix is simulated only once and the differing suffixes
+// branch from a copy of its state.
+// Returns the expectation of the Z-parity of the measured qubits for each
+// kernel (i.e. the AcceleratorBuffer exp-val-z), or an empty vector if any
+// kernel contains a gate that is not supported by the local simulator.
+std::vector<double> evaluateSharedPrefix(
+    const std::vector<std::shared_ptr<CompositeInstruction>> &in_kernels);
+
+// One optimizer run of a multi-start optimization.
+struct OptimizationTrajectory {
+  std::vector<double> initial_params;
+  std::vector<double> opt_params;
+  double energy;
+  // Objective value of every evaluation
+  std::vector<double> energies;
+  // Stopped early since not competitive with the best run
+  bool pruned = false;
+};
+
+// Objective function of a single run (given its index), must own
+// independent (evaluator) state if the runs are executed in parallel.
+using ObjectiveFactory = std::function<
+    std::function<double(const std::vector<double> &, std::vector<double> &)>(
+        size_t)>;
+
+// Run the optimization from multiple random initial points.
+// Options:
+//  - "starts" (int, default 1): number of independent runs.
+//  - "parallel" (bool, default false): execute the runs concurrently, each
+//    with its own optimizer instance created from the optimizer name and the
+//    "optimizer-options" map. Ignored (with a warning) if the optimizer is a
+//    shared service. The objectives must be thread-safe: the VQE and QAOA
+//    (circuit) workflows, which share the accelerator, run sequentially.
+//  - "seed" (int): seed of the initial points (run i uses seed + i).
+//  - "init-range" (double, default 1.0): initial points are uniform in
+//    [-init-range, init-range].
+//  - "prune-after" (int, default 0 = never), "prune-tolerance" (double,
+//    default 0.1): a run whose best energy is still above the global best
+//    energy + tolerance after this many evaluations is stopped.
+// Returns one trajectory per run.
+std::vector<OptimizationTrajectory>
+multiStartOptimize(std::shared_ptr<Optimizer> in_optimizer, size_t in_nbParams,
+                   const ObjectiveFactory &in_objectiveFactory,
+                   const HeterogeneousMap &in_params);
+
+// Workflow result of a multi-start optimization: "energy" and "opt-params"
+// of the best run; for more than one run, also the per-run "energies",
+// "opt-params-list", "initial-params-list", "trajectories" (energy of
+// every evaluation) and "pruned".
+QuantumSimulationResult
+multiStartResult(const std::vector<OptimizationTrajectory> &in_runs);
+
+// Snapshot of a workflow state (named arrays of numbers and strings) for
+// checkpoint/resume, stored in a compact binary file (native byte order).
+// The file is written to a temporary and then renamed, so that an
+// interrupted write never corrupts the previous checkpoint.
+class WorkflowCheckpoint {
+public:
+  WorkflowCheckpoint(const std::string &in_workflow = "")
+      : m_workflow(in_workflow) {}
+  const std::string &workflow() const { return m_workflow; }
+
+  void setValues(const std::string &in_key, const std::vector<double> &in_vals);
+  void setStrings(const std::string &in_key,
+                  const std::vector<std::string> &in_vals);
+  bool hasValues(const std::string &in_key) const;
+  bool hasStrings(const std::string &in_key) const;
+  // Throws if the key doesn't exist.
+  const std::vector<double> &getValues(const std::string &in_key) const;
+  const std::vector<std::string> &getStrings(const std::string &in_key) const;
+
+  void save(const std::string &in_fileName) const;
+  // Load a checkpoint file, which must have been written by the same
+  // workflow type.
+  static WorkflowCheckpoint load(const std::string &in_fileName,
+                                 const std::string &in_workflow);
+
+private:
+  std::string m_workflow;
+  std::map<std::string, std::vector<double>> m_values;
+  std::map<std::string, std::vector<std::string>> m_strings;
+};
+
+// Checkpoint options of long-running workflows:
+//  - "checkpoint" (string): file to save the workflow state to.
+//  - "checkpoint-interval" (int, default 1): save every n steps/iterations.
+//  - "resume-from" (string): checkpoint file to resume from.
+struct CheckpointOptions {
+  std::string file;
+  int interval = 1;
+  std::string resume_from;
+  static CheckpointOptions fromParams(const HeterogeneousMap &in_params);
+  // Checkpoint due after the given (1-based) number of completed steps
+  bool isDue(int in_completed, int in_total) const {
+    return !file.empty() &&
+           (in_completed % interval == 0 || in_completed == in_total);
+  }
+};
 } // namespace qsim
 } // namespace qcor
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "iterative_qpe.hpp"
+#include "qcor_state_vector.hpp"
+#include "qsim_utils.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 
@@ -15,13 +17,28 @@ bool IterativeQpeWorkflow::initialize(const HeterogeneousMap &params) {
   if (params.keyExists<int>("iterations")) {
     num_iters = params.get<int>("iterations");
   }
+
+  trotter_params = HeterogeneousMap();
+  if (params.keyExists<int>("order")) {
+    trotter_params.insert("order", params.get<int>("order"));
+  }
+  if (params.keyExists<bool>("group-terms")) {
+    trotter_params.insert("group-terms", params.get<bool>("group-terms"));
+  }
+
+  repeated_squaring = false;
+  if (params.keyExists<bool>("repeated-squaring")) {
+    repeated_squaring = params.get<bool>("repeated-squaring");
+  }
+  checkpoint_options = CheckpointOptions::fromParams(params);
   return (num_steps >= 1) && (num_iters >= 1);
 }
 
 std::shared_ptr<CompositeInstruction>
 IterativeQpeWorkflow::constructQpeTrotterCircuit(
     std::shared_ptr<Observable> obs, double trotter_step, size_t nbQubits,
-    double compensatedAncRot, int steps, int k, double omega) {
+    double compensatedAncRot, int steps, int k, double omega,
+    const HeterogeneousMap &trotter_params) {
   auto provider = xacc::getIRProvider("quantum");
   auto kernel = provider->createComposite("__TEMP__QPE__LOOP__");
   // Ancilla qubit is the last one in the register.
@@ -35,10 +52,11 @@ IterativeQpeWorkflow::constructQpeTrotterCircuit(
         provider->createInstruction("Rz", {ancBit}, {compensatedAncRot}));
   }
   // Using Trotter evolution method to generate U:
-  // TODO: support other methods (e.g. Suzuki)
+  // (higher-order Suzuki formulas via the "order" option)
   auto method = xacc::getService<AnsatzGenerator>("trotter");
-  auto trotterCir =
-      method->create_ansatz(obs.get(), {{"dt", trotter_step}}).circuit;
+  HeterogeneousMap method_params = trotter_params;
+  method_params.insert("dt", trotter_step);
+  auto trotterCir = method->create_ansatz(obs.get(), method_params).circuit;
   // std::cout << "Trotter circ:\n" << trotterCir->toString() << "\n";
 
   // Controlled-U
@@ -50,13 +68,10 @@ IterativeQpeWorkflow::constructQpeTrotterCircuit(
   });
 
   // Apply C-U^n
+  // The controlled kernel is stored once with its repeat count (the circuit
+  // doesn't grow exponentially with k).
   int power = 1 << (k - 1);
-  for (int i = 0; i < power * steps; ++i) {
-    for (int instId = 0; instId < ctrlKernel->nInstructions(); ++instId) {
-      // We need to clone the instruction since it'll be repeated.
-      kernel->addInstruction(ctrlKernel->getInstruction(instId)->clone());
-    }
-  }
+  kernel->addInstruction(createRepeatComposite(ctrlKernel, power * steps));
 
   // Rz on ancilla qubit
   // Global phase due to identity pauli
@@ -82,7 +97,8 @@ std::shared_ptr<CompositeInstruction> IterativeQpeWorkflow::constructQpeCircuit(
   auto provider = xacc::getIRProvider("quantum");
   const double trotterStepSize = -2 * M_PI / num_steps;
   auto kernel = constructQpeTrotterCircuit(obs, trotterStepSize, obs->nBits(),
-                                           0.0, num_steps, k, omega);
+                                           0.0, num_steps, k, omega,
+                                           trotter_params);
   const auto nbQubits = obs->nBits();
 
   // Ancilla qubit is the last one in the register
@@ -97,6 +113,64 @@ std::shared_ptr<CompositeInstruction> IterativeQpeWorkflow::constructQpeCircuit(
   return kernel;
 }
 
+double IterativeQpeWorkflow::simulateQpeIteration(
+    std::shared_ptr<Observable> obs,
+    std::shared_ptr<CompositeInstruction> state_prep, int k,
+    double omega) const {
+  auto provider = xacc::getIRProvider("quantum");
+  const size_t nbQubits = obs->nBits();
+  const size_t ancBit = nbQubits;
+  const double trotterStepSize = -2 * M_PI / num_steps;
+  auto method = xacc::getService<AnsatzGenerator>("trotter");
+  HeterogeneousMap method_params = trotter_params;
+  method_params.insert("dt", trotterStepSize);
+  auto trotterCir = method->create_ansatz(obs.get(), method_params).circuit;
+  for (auto &inst : StateVector::flatten(trotterCir)) {
+    if (!StateVector::is_supported(inst)) {
+      xacc::error("IQPE repeated-squaring: unsupported gate " + inst->name());
+    }
+  }
+
+  // Unitary matrix of a single Trotter step (column by column)
+  const size_t dim = 1ULL << nbQubits;
+  Eigen::MatrixXcd stepUnitary(dim, dim);
+  for (size_t col = 0; col < dim; ++col) {
+    StateVector basisState(Eigen::VectorXcd::Unit(dim, col));
+    basisState.apply(trotterCir);
+    stepUnitary.col(col) = basisState.amplitudes();
+  }
+
+  // U^(steps * 2^(k-1)): steps multiplications and (k-1) squarings
+  Eigen::MatrixXcd evolution = Eigen::MatrixXcd::Identity(dim, dim);
+  for (int i = 0; i < num_steps; ++i) {
+    evolution = stepUnitary * evolution;
+  }
+  for (int i = 1; i < k; ++i) {
+    evolution = evolution * evolution;
+  }
+
+  // Same circuit as constructQpeCircuit, ancilla is the most significant bit
+  StateVector state(nbQubits + 1);
+  if (state_prep) {
+    state.apply(state_prep);
+  }
+  state.apply(provider->createInstruction("H", ancBit));
+  // Controlled-U^n: acts on the half of the amplitudes where ancilla = 1
+  state.amplitudes().tail(dim) = evolution * state.amplitudes().tail(dim);
+  if (obs->getIdentitySubTerm()) {
+    const int power = 1 << (k - 1);
+    const double idCoeff = obs->getIdentitySubTerm()->coefficient().real();
+    const double globalPhase = 2 * M_PI * idCoeff * power;
+    state.apply(provider->createInstruction("Rz", {ancBit}, {globalPhase}));
+  }
+  state.apply(provider->createInstruction("Rz", {ancBit}, {omega}));
+  state.apply(provider->createInstruction("H", ancBit));
+
+  // <Z> of the ancilla qubit
+  const double prob1 = state.amplitudes().tail(dim).squaredNorm();
+  return 1.0 - 2.0 * prob1;
+}
+
 void IterativeQpeWorkflow::HamOpConverter::fromObservable(Observable *obs) {
   translation = 0.0;
   for (auto &term : obs->getSubTerms()) {
@@ -133,9 +207,31 @@ IterativeQpeWorkflow::execute(const QuantumSimulationModel &model) {
   // We're using XACC IR construction API here, since using QCOR kernels here
   // seems to be complicated.
   double omega_coef = 0.0;
+  int firstIter = 0;
+  if (!checkpoint_options.resume_from.empty()) {
+    // Resume from the phase bits measured in the completed iterations.
+    const auto checkpoint =
+        WorkflowCheckpoint::load(checkpoint_options.resume_from, name());
+    if (checkpoint.getValues("iterations")[0] != num_iters) {
+      xacc::error("IQPE checkpoint " + checkpoint_options.resume_from +
+                  " was created for a different number of iterations.");
+    }
+    firstIter = checkpoint.getValues("completed")[0];
+    omega_coef = checkpoint.getValues("omega-coef")[0];
+  }
+  const auto saveCheckpoint = [&](int in_completed) {
+    if (checkpoint_options.isDue(in_completed, num_iters)) {
+      WorkflowCheckpoint checkpoint(name());
+      checkpoint.setValues("iterations", {(double)num_iters});
+      checkpoint.setValues("completed", {(double)in_completed});
+      checkpoint.setValues("omega-coef", {omega_coef});
+      checkpoint.save(checkpoint_options.file);
+    }
+  };
+
   // Iterates over the num_iters
   // k runs from the number of iterations back to 1
-  for (int iterIdx = 0; iterIdx < num_iters; ++iterIdx) {
+  for (int iterIdx = firstIter; iterIdx < num_iters; ++iterIdx) {
     // State prep: evolves the qubit register to the initial quantum state, i.e.
     // the eigenvector state to estimate the eigenvalue.
     auto kernel = provider->createComposite("__TEMP__ITER_QPE__");
@@ -146,6 +242,17 @@ IterativeQpeWorkflow::execute(const QuantumSimulationModel &model) {
     // Construct the QPE circuit and append to the kernel:
     auto k = num_iters - iterIdx;
 
+    if (repeated_squaring) {
+      // Local simulation: U^(2^(k-1)) is computed by repeated squaring
+      // instead of simulating all the controlled-U repetitions.
+      const double expZ =
+          simulateQpeIteration(stretchedObs, kernel, k, -2 * M_PI * omega_coef);
+      if (expZ < 0.0) {
+        omega_coef = omega_coef + 0.5;
+      }
+      saveCheckpoint(iterIdx + 1);
+      continue;
+    }
     auto iterQpe = constructQpeCircuit(stretchedObs, k, -2 * M_PI * omega_coef);
     kernel->addInstruction(iterQpe);
     // Executes the iterative QPE algorithm:
@@ -180,6 +287,7 @@ IterativeQpeWorkflow::execute(const QuantumSimulationModel &model) {
     if (bitResult) {
       omega_coef = omega_coef + 0.5;
     }
+    saveCheckpoint(iterIdx + 1);
     // std::cout << "Iter " << iterIdx << ": Result = " << bitResult << ";
     // omega_coef = " << omega_coef << "\n";
   }
@@ -1,5 +1,6 @@
 #pragma once
 #include "qcor_qsim.hpp"
+#include "qsim_utils.hpp"
 
 namespace qcor {
 namespace qsim {
@@ -25,18 +26,29 @@ public:
 
   static std::shared_ptr<CompositeInstruction> constructQpeTrotterCircuit(
       std::shared_ptr<Observable> obs, double trotter_step, size_t nbQubits,
-      double compensatedAncRot = 0, int steps = 1, int k = 1, double omega = 0);
+      double compensatedAncRot = 0, int steps = 1, int k = 1, double omega = 0,
+      const HeterogeneousMap &trotter_params = {});
 
 private:
   std::shared_ptr<CompositeInstruction>
   constructQpeCircuit(std::shared_ptr<Observable> obs, int k, double omega,
                       bool measure = true) const;
+  // Local state-vector simulation of a QPE iteration,
+  // returns the <Z> value of the ancilla qubit.
+  double simulateQpeIteration(std::shared_ptr<Observable> obs,
+                              std::shared_ptr<CompositeInstruction> state_prep,
+                              int k, double omega) const;
 
 private:
   // Number of time slices (>=1)
   int num_steps;
   // Number of iterations (>=1)
   int num_iters;
+  // Extra Trotter generator options ("order", "group-terms")
+  HeterogeneousMap trotter_params;
+  // Use the local simulator fast path (U^(2^k) by repeated squaring)
+  bool repeated_squaring;
+  CheckpointOptions checkpoint_options;
   HamOpConverter ham_converter;
 };
 } // namespace qsim
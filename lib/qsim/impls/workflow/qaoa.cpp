@@ -1,6 +1,7 @@
 #include "qaoa.hpp"
 #include "AlgorithmGradientStrategy.hpp"
 #include "qsim_utils.hpp"
+#include "qcor_diagonal_qaoa.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 
@@ -37,12 +38,21 @@ QaoaWorkflow::execute(const QuantumSimulationModel &model) {
                        {"nbSteps", nbSteps},
                        {"cost-ham", model.observable},
                        {"parameter-scheme", parameterScheme}});
-  evaluator = getEvaluator(model.observable, config_params);
   size_t nParams = qaoa_kernel->nVariables();
   assert(nParams > 1);
-  const std::vector<double> init_params =
-      qcor::random_vector(-1.0, 1.0, nParams);
-  optimizer->appendOption("initial-parameters", init_params);
+
+  // Diagonal (Z-only) cost Hamiltonian: simulate the QAOA state directly
+  // (elementwise cost phases + X mixer rotations) with exact adjoint
+  // gradients rather than executing circuits on the accelerator.
+  bool diagonal_simulation = false;
+  if (config_params.keyExists<bool>("diagonal-simulation")) {
+    diagonal_simulation = config_params.get<bool>("diagonal-simulation");
+  }
+  if (diagonal_simulation) {
+    return executeDiagonal(model, qaoa_kernel, parameterScheme);
+  }
+
+  evaluator = getEvaluator(model.observable, config_params);
   std::shared_ptr<xacc::AlgorithmGradientStrategy> gradient_strategy;
   if (optimizer->isGradientBased()) {
     if (config_params.stringExists("gradient-strategy")) {
@@ -57,47 +67,120 @@ QaoaWorkflow::execute(const QuantumSimulationModel &model) {
         {{"observable", xacc::as_shared_ptr(model.observable)}});
   }
 
-  OptFunction f(
-      [&](const std::vector<double> &x, std::vector<double> &dx) {
-        auto kernel = qaoa_kernel->operator()(x);
-        auto energy = evaluator->evaluate(kernel);
-        if (gradient_strategy) {
-          if (gradient_strategy->isNumerical()) {
-            gradient_strategy->setFunctionValue(
-                energy -
-                (model.observable->getIdentitySubTerm() ? std::real(
-                    model.observable->getIdentitySubTerm()->coefficient()) : 0.0));
-          }
+  // Accelerator executions (and the gradient strategy service) are shared and
+  // not thread-safe: the starts always run sequentially.
+  auto multiStartParams = config_params;
+  if (multiStartParams.keyExists<bool>("parallel") &&
+      multiStartParams.get<bool>("parallel")) {
+    xacc::warning("QAOA workflow: 'parallel' is only supported by the "
+                  "diagonal simulator. Running starts sequentially.");
+    multiStartParams.insert("parallel", false);
+  }
+  auto objective_factory = [&](size_t start_idx) {
+    auto start_evaluator = (start_idx == 0)
+                               ? evaluator
+                               : getEvaluator(model.observable, config_params);
+    return [&, start_evaluator](const std::vector<double> &x,
+                                std::vector<double> &dx) {
+      auto kernel = qaoa_kernel->operator()(x);
+      auto energy = start_evaluator->evaluate(kernel);
+      if (gradient_strategy) {
+        if (gradient_strategy->isNumerical()) {
+          gradient_strategy->setFunctionValue(
+              energy -
+              (model.observable->getIdentitySubTerm() ? std::real(
+                  model.observable->getIdentitySubTerm()->coefficient()) : 0.0));
+        }
 
-          auto grad_kernels =
-              gradient_strategy->getGradientExecutions(qaoa_kernel, x);
+        auto grad_kernels =
+            gradient_strategy->getGradientExecutions(qaoa_kernel, x);
 
-          if (!grad_kernels.empty()) {
-            auto tmp_grad = qalloc(model.observable->nBits());
-            // Important note: these gradient kernels (not using the qsim
-            // evaluator) need to be processed by the pass manager (e.g. perform
-            // placement).
-            executePassManager(grad_kernels);
-            xacc::internal_compiler::execute(tmp_grad.results(), grad_kernels);
-            auto tmp_grad_children = tmp_grad.results()->getChildren();
-            gradient_strategy->compute(dx, tmp_grad_children);
-          }
-          // This is an autodiff gradient calculation:
-          else {
-            gradient_strategy->compute(dx, {});
-          }
+        if (!grad_kernels.empty()) {
+          auto tmp_grad = qalloc(model.observable->nBits());
+          // Important note: these gradient kernels (not using the qsim
+          // evaluator) need to be processed by the pass manager (e.g. perform
+          // placement).
+          executePassManager(grad_kernels);
+          xacc::internal_compiler::execute(tmp_grad.results(), grad_kernels);
+          auto tmp_grad_children = tmp_grad.results()->getChildren();
+          gradient_strategy->compute(dx, tmp_grad_children);
         }
-        // std::cout << "E(";
-        // for (const auto &val : x) {
-        //   std::cout << val << ",";
-        // }
-        // std::cout << ") = " << energy << "\n";
-        return energy;
-      },
-      nParams);
+        // This is an analytic (autodiff or adjoint) gradient calculation:
+        else {
+          gradient_strategy->compute(dx, {});
+        }
+      }
+      // std::cout << "E(";
+      // for (const auto &val : x) {
+      //   std::cout << val << ",";
+      // }
+      // std::cout << ") = " << energy << "\n";
+      return energy;
+    };
+  };
+
+  return multiStartResult(multiStartOptimize(
+      optimizer, nParams, objective_factory, multiStartParams));
+}
+
+QuantumSimulationResult QaoaWorkflow::executeDiagonal(
+    const QuantumSimulationModel &model,
+    std::shared_ptr<xacc::CompositeInstruction> qaoa_kernel,
+    const std::string &parameterScheme) {
+  auto pauli = dynamic_cast<PauliOperator *>(model.observable);
+  if (!pauli || !DiagonalQaoaSimulator::is_diagonal(*pauli)) {
+    xacc::error("QAOA 'diagonal-simulation' requires a Pauli observable with "
+                "Z terms only.");
+  }
+  if (parameterScheme != "Standard") {
+    xacc::error("QAOA 'diagonal-simulation' only supports the 'Standard' "
+                "parameter scheme.");
+  }
+  DiagonalQaoaSimulator simulator(*pauli);
+
+  // Map the kernel variables (one gamma and one beta per step) to their
+  // layers so that the optimizer sees the same parameter vector as the
+  // circuit-based path.
+  std::vector<std::size_t> gammaIdx, betaIdx;
+  const auto variables = qaoa_kernel->getVariables();
+  for (std::size_t i = 0; i < variables.size(); ++i) {
+    if (variables[i].rfind("gamma", 0) == 0) {
+      gammaIdx.emplace_back(i);
+    } else if (variables[i].rfind("beta", 0) == 0) {
+      betaIdx.emplace_back(i);
+    } else {
+      xacc::error("QAOA 'diagonal-simulation': unknown kernel variable " +
+                  variables[i]);
+    }
+  }
+  if (gammaIdx.size() != betaIdx.size()) {
+    xacc::error("QAOA 'diagonal-simulation': mismatched gamma/beta layers.");
+  }
+
+  // The simulator is stateless: concurrent starts share it.
+  auto objective_factory = [&](size_t) {
+    return [&](const std::vector<double> &x, std::vector<double> &dx) {
+      std::vector<std::vector<double>> gammas, betas;
+      for (std::size_t k = 0; k < gammaIdx.size(); ++k) {
+        gammas.push_back({x[gammaIdx[k]]});
+        betas.push_back({x[betaIdx[k]]});
+      }
+      if (dx.empty()) {
+        return simulator.expectation(gammas, betas);
+      }
+      std::vector<std::vector<double>> gammaGrads, betaGrads;
+      const double energy =
+          simulator.expectation(gammas, betas, &gammaGrads, &betaGrads);
+      for (std::size_t k = 0; k < gammaIdx.size(); ++k) {
+        dx[gammaIdx[k]] = gammaGrads[k][0];
+        dx[betaIdx[k]] = betaGrads[k][0];
+      }
+      return energy;
+    };
+  };
 
-  auto result = optimizer->optimize(f);
-  return {{"energy", (double)result.first}, {"opt-params", result.second}};
+  return multiStartResult(multiStartOptimize(
+      optimizer, variables.size(), objective_factory, config_params));
 }
 } // namespace qsim
-} // namespace qcor
\ No newline at end of file
+} // namespace qcor
@@ -13,6 +13,11 @@ public:
   virtual const std::string description() const override { return ""; }
 
 private:
+  QuantumSimulationResult
+  executeDiagonal(const QuantumSimulationModel &model,
+                  std::shared_ptr<xacc::CompositeInstruction> qaoa_kernel,
+                  const std::string &parameterScheme);
+
   std::shared_ptr<Optimizer> optimizer;
   HeterogeneousMap config_params;
 };
@@ -1,4 +1,5 @@
 #include "qite.hpp"
+#include "qcor_state_vector.hpp"
 #include "xacc.hpp"
 #include "xacc_service.hpp"
 #include "qsim_utils.hpp"
@@ -36,6 +37,59 @@ std::vector<std::string> generatePauliPermutation(int in_nbQubits) {
 
   return opsList;
 };
+
+// Parse a Pauli string, e.g. "X0Z2", into a (qubit -> op) map.
+std::map<int, char> parsePauliString(const std::string &in_pauliStr) {
+  std::map<int, char> result;
+  size_t pos = 0;
+  while (pos < in_pauliStr.size()) {
+    const char op = in_pauliStr[pos++];
+    size_t end = pos;
+    while (end < in_pauliStr.size() && std::isdigit(in_pauliStr[end])) {
+      ++end;
+    }
+    result[std::stoi(in_pauliStr.substr(pos, end - pos))] = op;
+    pos = end;
+  }
+  return result;
+}
+
+// Measurement basis that covers a Pauli string: its op on the support,
+// Z elsewhere, e.g. "X0Z2" -> "XZZ" (3 qubits). Character i is qubit i.
+std::string measureBasis(const std::map<int, char> &in_pauli, int in_nbQubits) {
+  std::string basis(in_nbQubits, 'Z');
+  for (const auto &[qubit, op] : in_pauli) {
+    basis[qubit] = op;
+  }
+  return basis;
+}
+
+// <psi|P|psi> from the state-vector amplitudes, using
+// P|i> = i^{nY} (-1)^{|i & zmask|} |i ^ xmask>
+double pauliExpectation(const Eigen::VectorXcd &in_state,
+                        const std::map<int, char> &in_pauli) {
+  size_t xmask = 0, zmask = 0;
+  int nY = 0;
+  for (const auto &[qubit, op] : in_pauli) {
+    if (op == 'X' || op == 'Y') {
+      xmask |= 1ULL << qubit;
+    }
+    if (op == 'Z' || op == 'Y') {
+      zmask |= 1ULL << qubit;
+    }
+    if (op == 'Y') {
+      nY++;
+    }
+  }
+  static const std::complex<double> iPowers[4] = {
+      {1.0, 0.0}, {0.0, 1.0}, {-1.0, 0.0}, {0.0, -1.0}};
+  std::complex<double> result = 0.0;
+  for (size_t i = 0; i < (size_t)in_state.size(); ++i) {
+    const double sign = (__builtin_popcountll(i & zmask) % 2) ? -1.0 : 1.0;
+    result += std::conj(in_state[i ^ xmask]) * sign * in_state[i];
+  }
+  return std::real(iPowers[nY % 4] * result);
+}
 } // namespace
 
 namespace qcor {
@@ -52,6 +106,7 @@ bool QiteWorkflow::initialize(const HeterogeneousMap &params) {
     initializeOk = false;
   }
   config_params = params;
+  checkpoint_options = CheckpointOptions::fromParams(params);
   return initializeOk;
 }
 
@@ -70,6 +125,8 @@ QiteWorkflow::execute(const QuantumSimulationModel &model) {
   
   // Approximate imaginary-time Hamiltonian
   std::vector<std::shared_ptr<Observable>> approxOps;
+  // String representation of approxOps (checkpoint)
+  std::vector<std::string> approxOpsStr;
   std::vector<double> energyAtStep;
 
   auto constructPropagateCircuit =
@@ -111,29 +168,207 @@ QiteWorkflow::execute(const QuantumSimulationModel &model) {
     return evaluator->evaluate(propagateKernel);
   };
 
-  // Initial energy
-  energyAtStep.emplace_back(calcCurrentEnergy());
-  const auto pauliOps = generatePauliPermutation(nbQubits);
-  const auto evaluateTomographyAtStep = [&](const std::shared_ptr<CompositeInstruction>& in_kernel) {
-    // Observe the kernels using the various Pauli
-    // operators to calculate S and b.
-    std::vector<double> sigmaExpectation(pauliOps.size());
-    sigmaExpectation[0] = 1.0;
-    for (int i = 1; i < pauliOps.size(); ++i) {
-      std::shared_ptr<Observable> tomoObservable =
-          std::make_shared<xacc::quantum::PauliOperator>();
-      const std::string pauliObsStr = "1.0 " + pauliOps[i];
-      tomoObservable->fromString(pauliObsStr);
-      assert(tomoObservable->getSubTerms().size() == 1);
-      assert(tomoObservable->getNonIdentitySubTerms().size() == 1);
-      auto temp_evaluator = getEvaluator(tomoObservable.get(), config_params);
-      sigmaExpectation[i] = temp_evaluator->evaluate(in_kernel);
+  // Pauli tomography method:
+  // - "shared-basis" (default): measure in the 3^n product bases and derive
+  // all 4^n Pauli expectations from the shared measurement counts. Falls
+  // back to "pauli" if the backend returns no counts (exact simulators).
+  // - "state-vector": exact expectations from a local noiseless state-vector
+  // simulation of the kernel (the accelerator and evaluator are not used).
+  // - "pauli": one evaluation per Pauli operator, using the configured
+  // evaluator (the default if an evaluator is provided).
+  const bool hasEvaluator =
+      config_params.pointerLikeExists<CostFunctionEvaluator>("evaluator") ||
+      config_params.stringExists("evaluator");
+  std::string tomography = hasEvaluator ? "pauli" : "shared-basis";
+  if (config_params.stringExists("tomography")) {
+    tomography = config_params.getString("tomography");
+  }
+  if (tomography != "shared-basis" && tomography != "state-vector" &&
+      tomography != "pauli") {
+    xacc::error("Unknown QITE tomography method '" + tomography + "'.");
+  }
+  if (hasEvaluator && tomography != "pauli") {
+    xacc::error("QITE '" + tomography +
+                "' tomography does not use the evaluator, use 'pauli' "
+                "tomography with an evaluator.");
+  }
+
+  if (!checkpoint_options.resume_from.empty()) {
+    // Resume from the A-operators and energies of the completed steps.
+    const auto checkpoint =
+        WorkflowCheckpoint::load(checkpoint_options.resume_from, name());
+    if (checkpoint.getValues("nb-qubits")[0] != nbQubits) {
+      xacc::error("QITE checkpoint " + checkpoint_options.resume_from +
+                  " was created for a different number of qubits.");
+    }
+    approxOpsStr = checkpoint.getStrings("approx-ops");
+    for (const auto &aOpsStr : approxOpsStr) {
+      approxOps.emplace_back(createObservable(aOpsStr));
     }
-    return sigmaExpectation;
+    energyAtStep = checkpoint.getValues("energies");
+    // The shared-basis tomography may have fallen back to another method.
+    tomography = checkpoint.getStrings("tomography")[0];
+  } else {
+    // Initial energy
+    energyAtStep.emplace_back(calcCurrentEnergy());
+  }
+
+  const auto saveCheckpoint = [&]() {
+    WorkflowCheckpoint checkpoint(name());
+    checkpoint.setValues("nb-qubits", {(double)nbQubits});
+    checkpoint.setValues("energies", energyAtStep);
+    checkpoint.setStrings("approx-ops", approxOpsStr);
+    checkpoint.setStrings("tomography", {tomography});
+    checkpoint.save(checkpoint_options.file);
   };
 
-  // Main QITE time-stepping loop:
-  for (int i = 0; i < nbSteps; ++i) {
+  const auto pauliOps = generatePauliPermutation(nbQubits);
+  const std::vector<std::map<int, char>> parsedPauliOps = [&]() {
+    std::vector<std::map<int, char>> parsed;
+    for (const auto &pauliStr : pauliOps) {
+      parsed.emplace_back(parsePauliString(pauliStr));
+    }
+    return parsed;
+  }();
+
+  const auto evaluatePauliTomography =
+      [&](const std::shared_ptr<CompositeInstruction> &in_kernel) {
+        // Observe the kernels using the various Pauli
+        // operators to calculate S and b.
+        std::vector<double> sigmaExpectation(pauliOps.size());
+        sigmaExpectation[0] = 1.0;
+        for (int i = 1; i < pauliOps.size(); ++i) {
+          std::shared_ptr<Observable> tomoObservable =
+              std::make_shared<xacc::quantum::PauliOperator>();
+          const std::string pauliObsStr = "1.0 " + pauliOps[i];
+          tomoObservable->fromString(pauliObsStr);
+          assert(tomoObservable->getSubTerms().size() == 1);
+          assert(tomoObservable->getNonIdentitySubTerms().size() == 1);
+          auto temp_evaluator =
+              getEvaluator(tomoObservable.get(), config_params);
+          sigmaExpectation[i] = temp_evaluator->evaluate(in_kernel);
+        }
+        return sigmaExpectation;
+      };
+
+  const auto evaluateStateVectorTomography =
+      [&](const std::shared_ptr<CompositeInstruction> &in_kernel) {
+        StateVector state(std::max<size_t>(
+            nbQubits, StateVector::required_qubits(in_kernel)));
+        state.apply(in_kernel);
+        std::vector<double> sigmaExpectation(pauliOps.size());
+        sigmaExpectation[0] = 1.0;
+        for (int i = 1; i < pauliOps.size(); ++i) {
+          sigmaExpectation[i] =
+              pauliExpectation(state.amplitudes(), parsedPauliOps[i]);
+        }
+        return sigmaExpectation;
+      };
+
+  const auto isStateVectorSupported =
+      [](const std::shared_ptr<CompositeInstruction> &in_kernel) {
+        const auto insts = StateVector::flatten(in_kernel);
+        return std::all_of(insts.begin(), insts.end(),
+                           [](auto &inst) {
+                             return StateVector::is_supported(inst);
+                           });
+      };
+
+  // Returns an empty vector if the backend doesn't return measurement counts.
+  const auto evaluateSharedBasisTomography =
+      [&](const std::shared_ptr<CompositeInstruction> &in_kernel) {
+        auto provider = xacc::getIRProvider("quantum");
+        // Measurement basis of each Pauli op
+        std::vector<std::string> pauliBasis(pauliOps.size());
+        std::map<std::string, size_t> basisToIdx;
+        std::vector<std::shared_ptr<CompositeInstruction>> basisKernels;
+        for (int i = 1; i < pauliOps.size(); ++i) {
+          pauliBasis[i] = measureBasis(parsedPauliOps[i], nbQubits);
+          if (basisToIdx.find(pauliBasis[i]) != basisToIdx.end()) {
+            continue;
+          }
+          basisToIdx[pauliBasis[i]] = basisKernels.size();
+          auto basisKernel =
+              provider->createComposite("__QITE_TOMO__" + pauliBasis[i]);
+          basisKernel->addInstruction(in_kernel);
+          for (size_t qubit = 0; qubit < nbQubits; ++qubit) {
+            if (pauliBasis[i][qubit] == 'X') {
+              basisKernel->addInstruction(provider->createInstruction("H", qubit));
+            } else if (pauliBasis[i][qubit] == 'Y') {
+              basisKernel->addInstruction(
+                  provider->createInstruction("Rx", {qubit}, {M_PI_2}));
+            }
+          }
+          for (size_t qubit = 0; qubit < nbQubits; ++qubit) {
+            basisKernel->addInstruction(
+                provider->createInstruction("Measure", qubit));
+          }
+          basisKernels.emplace_back(basisKernel);
+        }
+
+        auto temp_buffer = xacc::qalloc(nbQubits);
+        xacc::internal_compiler::execute(temp_buffer.get(), basisKernels);
+        auto children = temp_buffer->getChildren();
+        if (children.size() != basisKernels.size()) {
+          xacc::error("QITE tomography: execution returned " +
+                      std::to_string(children.size()) + " results, expected " +
+                      std::to_string(basisKernels.size()));
+        }
+        for (auto &child : children) {
+          if (child->getMeasurementCounts().empty()) {
+            return std::vector<double>{};
+          }
+        }
+
+        // Character position of each qubit in the bitstrings
+        const bool msb = xacc::internal_compiler::get_qpu()->getBitOrder() ==
+                         Accelerator::BitOrder::MSB;
+        std::vector<double> sigmaExpectation(pauliOps.size());
+        sigmaExpectation[0] = 1.0;
+        for (int i = 1; i < pauliOps.size(); ++i) {
+          auto &child = children[basisToIdx[pauliBasis[i]]];
+          int totalCount = 0;
+          int parityCount = 0;
+          for (const auto &[bitString, count] :
+               child->getMeasurementCounts()) {
+            int parity = 0;
+            for (const auto &[qubit, op] : parsedPauliOps[i]) {
+              const size_t pos = msb ? nbQubits - 1 - qubit : qubit;
+              parity ^= (bitString[pos] == '1');
+            }
+            totalCount += count;
+            parityCount += parity ? -count : count;
+          }
+          sigmaExpectation[i] = (double)parityCount / totalCount;
+        }
+        return sigmaExpectation;
+      };
+
+  const auto evaluateTomographyAtStep =
+      [&](const std::shared_ptr<CompositeInstruction> &in_kernel) {
+        if (tomography == "shared-basis") {
+          auto sigmaExpectation = evaluateSharedBasisTomography(in_kernel);
+          if (!sigmaExpectation.empty()) {
+            return sigmaExpectation;
+          }
+          // The backend computes exact expectation values (no shots),
+          // use the per-term tomography, still on the configured backend.
+          tomography = "pauli";
+          xacc::info("QITE: no measurement counts returned, using 'pauli' "
+                     "tomography.");
+        }
+        if (tomography == "state-vector") {
+          if (!isStateVectorSupported(in_kernel)) {
+            xacc::error("QITE: the kernel contains gates not supported by "
+                        "state-vector tomography.");
+          }
+          return evaluateStateVectorTomography(in_kernel);
+        }
+        return evaluatePauliTomography(in_kernel);
+      };
+
+  // Main QITE time-stepping loop (from the last completed step if resumed):
+  for (int i = approxOps.size(); i < nbSteps; ++i) {
     // Propagates the state via Trotter steps:
     auto kernel = constructPropagateCircuit(approxOps, model.user_defined_ansatz, stepSize);
     const std::vector<double> sigmaExpectation = evaluateTomographyAtStep(kernel);
@@ -144,7 +379,11 @@ QiteWorkflow::execute(const QuantumSimulationModel &model) {
     const std::string AopsStr = tmp_buffer.results()->getInformation("Aops-str").as<std::string>();
     auto new_approx_ops = createObservable(AopsStr);
     approxOps.emplace_back(new_approx_ops);
+    approxOpsStr.emplace_back(AopsStr);
     energyAtStep.emplace_back(calcCurrentEnergy());
+    if (checkpoint_options.isDue(i + 1, nbSteps)) {
+      saveCheckpoint();
+    }
   }
 
   // Returns:
@@ -1,5 +1,6 @@
 #pragma once
 #include "qcor_qsim.hpp"
+#include "qsim_utils.hpp"
 
 namespace qcor {
 namespace qsim {
@@ -14,6 +15,7 @@ public:
 
 private:
   HeterogeneousMap config_params;
+  CheckpointOptions checkpoint_options;
 };
 } // namespace qsim
 } // namespace qcor
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "qcor.hpp"
+#include "qcor_qsim.hpp"
+#include "qcor_state_vector.hpp"
+#include "utils/qsim_utils.hpp"
+#include "xacc.hpp"
+#include <gtest/gtest.h>
+
+TEST(IqpeWorkflowTester, checkRepeatedSquaring) {
+  using namespace qcor;
+  // |00> is an eigenstate with energy 0.2 + 0.5 - 0.3 = 0.4
+  auto observable = 0.2 + 0.5 * Z(0) - 0.3 * Z(0) * Z(1);
+  xacc::internal_compiler::qpu = xacc::getAccelerator("qpp");
+  auto problemModel = qsim::ModelBuilder::createModel(&observable);
+  std::vector<double> phases;
+  for (const bool repeated_squaring : {false, true}) {
+    auto workflow = qsim::getWorkflow(
+        "iqpe", {{"time-steps", 2},
+                 {"iterations", 6},
+                 {"repeated-squaring", repeated_squaring}});
+    auto result = workflow->execute(problemModel);
+    phases.emplace_back(result.get<double>("phase"));
+    EXPECT_NEAR(result.get<double>("energy"), 0.4, 0.1);
+  }
+  EXPECT_NEAR(phases[0], phases[1], 1e-9);
+}
+
+TEST(IqpeWorkflowTester, checkSuzukiOrder) {
+  using namespace qcor;
+  // Same phase with the exp_i_theta (order 1) and Suzuki (order 2)
+  // Trotter circuits (same sign convention).
+  auto observable = 0.2 + 0.5 * Z(0) - 0.3 * Z(0) * Z(1);
+  xacc::internal_compiler::qpu = xacc::getAccelerator("qpp");
+  auto problemModel = qsim::ModelBuilder::createModel(&observable);
+  std::vector<double> phases;
+  for (const int order : {1, 2}) {
+    auto workflow = qsim::getWorkflow(
+        "iqpe", {{"time-steps", 2}, {"iterations", 6}, {"order", order}});
+    auto result = workflow->execute(problemModel);
+    phases.emplace_back(result.get<double>("phase"));
+    EXPECT_NEAR(result.get<double>("energy"), 0.4, 0.1);
+  }
+  EXPECT_NEAR(phases[0], phases[1], 1e-9);
+}
+
+TEST(IqpeWorkflowTester, checkRepeatComposite) {
+  using namespace qcor;
+  auto provider = xacc::getIRProvider("quantum");
+  auto body = provider->createComposite("body");
+  body->addInstruction(provider->createInstruction("Rx", {0}, {0.1}));
+  auto repeat = qsim::createRepeatComposite(body, 10);
+  auto program = provider->createComposite("program");
+  program->addInstruction(repeat);
+  program->addInstruction(provider->createInstruction("Measure", 0));
+  // The body is stored once with its count: the repetitions are references
+  EXPECT_TRUE(qsim::isRepeatComposite(repeat));
+  EXPECT_EQ(qsim::getRepeatCount(repeat), 10);
+  EXPECT_EQ(repeat->nInstructions(), 10);
+  EXPECT_EQ(repeat->getInstruction(9), body);
+  // Other IR consumers see the 10 repetitions
+  EXPECT_EQ(StateVector::flatten(program).size(), 11);
+  // Local evaluation: <Z> = cos(10 * 0.1)
+  EXPECT_NEAR(qsim::evaluateSharedPrefix({program})[0], std::cos(1.0), 1e-9);
+  // Not expanded for a backend without placement (no connectivity)
+  xacc::internal_compiler::qpu = xacc::getAccelerator("qpp");
+  qsim::executePassManager({program});
+  EXPECT_TRUE(qsim::isRepeatComposite(repeat));
+  // Expanded into independent copies
+  qsim::expandRepeatComposites(program);
+  EXPECT_FALSE(qsim::isRepeatComposite(repeat));
+  EXPECT_EQ(repeat->nInstructions(), 10);
+  EXPECT_NE(repeat->getInstruction(9), body);
+  EXPECT_NEAR(qsim::evaluateSharedPrefix({program})[0], std::cos(1.0), 1e-9);
+}
+
+TEST(IqpeWorkflowTester, checkCheckpointResume) {
+  using namespace qcor;
+  auto observable = 0.2 + 0.5 * Z(0) - 0.3 * Z(0) * Z(1);
+  xacc::internal_compiler::qpu = xacc::getAccelerator("qpp");
+  auto problemModel = qsim::ModelBuilder::createModel(&observable);
+  const std::string checkpointFile = "iqpe_checkpoint_test.bin";
+  auto fullRun = qsim::getWorkflow(
+      "iqpe", {{"time-steps", 2},
+               {"iterations", 6},
+               {"checkpoint", checkpointFile},
+               {"checkpoint-interval", 4}})->execute(problemModel);
+  // The last checkpoint is always saved on completion.
+  auto checkpoint = qsim::WorkflowCheckpoint::load(checkpointFile, "iqpe");
+  EXPECT_EQ(checkpoint.getValues("completed")[0], 6);
+  EXPECT_NEAR(checkpoint.getValues("omega-coef")[0],
+              fullRun.get<double>("phase"), 1e-12);
+
+  // Resume after the first 3 iterations.
+  double omega = 0.0;
+  const double phase = fullRun.get<double>("phase");
+  for (int i = 0; i < 3; ++i) {
+    // Phase bits are measured from the least significant one.
+    const int bit = (int)std::round(phase * 64) >> i & 1;
+    omega = omega / 2.0 + 0.5 * bit;
+  }
+  checkpoint.setValues("completed", {3.0});
+  checkpoint.setValues("omega-coef", {omega});
+  checkpoint.save(checkpointFile);
+  auto resumed = qsim::getWorkflow(
+      "iqpe", {{"time-steps", 2},
+               {"iterations", 6},
+               {"resume-from", checkpointFile}})->execute(problemModel);
+  EXPECT_NEAR(phase, resumed.get<double>("phase"), 1e-12);
+  std::remove(checkpointFile.c_str());
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize();
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
@@ -1,6 +1,7 @@
 #include "qcor.hpp"
 #include "qcor_qsim.hpp"
 #include "xacc.hpp"
+#include <algorithm>
 #include <gtest/gtest.h>
 
 TEST(QaoaWorkflowTester, checkGradientFree) {
@@ -31,6 +32,49 @@ TEST(QaoaWorkflowTester, checkGradient) {
   EXPECT_NEAR(maxCutVal, 2.0, 0.1);
 }
 
+TEST(QaoaWorkflowTester, checkDiagonalSimulation) {
+  using namespace qcor;
+  auto observable = Z(0)*Z(1) + Z(0)*Z(2) + Z(1)*Z(2);
+  auto problemModel = qsim::ModelBuilder::createModel(&observable);
+  auto optimizer = createOptimizer("mlpack");
+  auto workflow = qsim::getWorkflow(
+      "qaoa", {{"optimizer", optimizer}, {"diagonal-simulation", true}});
+  auto result = workflow->execute(problemModel);
+  const auto energy = result.get<double>("energy");
+  std::cout << "Min energy: " << energy << "\n";
+  const double maxCutVal = -0.5*energy + 0.5*3;
+  EXPECT_NEAR(maxCutVal, 2.0, 0.1);
+}
+
+TEST(QaoaWorkflowTester, checkMultiStart) {
+  using namespace qcor;
+  auto observable = Z(0)*Z(1) + Z(0)*Z(2) + Z(1)*Z(2);
+  auto problemModel = qsim::ModelBuilder::createModel(&observable);
+  auto optimizer = createOptimizer("mlpack");
+  auto workflow = qsim::getWorkflow("qaoa", {{"optimizer", optimizer},
+                                             {"diagonal-simulation", true},
+                                             {"steps", 2},
+                                             {"starts", 4},
+                                             {"parallel", true},
+                                             {"seed", 42}});
+  auto result = workflow->execute(problemModel);
+  const auto energy = result.get<double>("energy");
+  const auto energies = result.get<std::vector<double>>("energies");
+  const auto trajectories =
+      result.get<std::vector<std::vector<double>>>("trajectories");
+  EXPECT_EQ(energies.size(), 4);
+  EXPECT_EQ(trajectories.size(), 4);
+  // The best start is reported, each start with its best evaluation.
+  for (size_t i = 0; i < energies.size(); ++i) {
+    EXPECT_LE(energy, energies[i]);
+    EXPECT_DOUBLE_EQ(
+        *std::min_element(trajectories[i].begin(), trajectories[i].end()),
+        energies[i]);
+  }
+  const double maxCutVal = -0.5*energy + 0.5*3;
+  EXPECT_NEAR(maxCutVal, 2.0, 0.1);
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
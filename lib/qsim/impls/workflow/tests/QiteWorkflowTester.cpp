@@ -1,5 +1,6 @@
 #include "qcor.hpp"
 #include "qcor_qsim.hpp"
+#include "utils/qsim_utils.hpp"
 #include "xacc.hpp"
 #include <gtest/gtest.h>
 
@@ -24,6 +25,68 @@ TEST(QiteWorkflowTester, checkSimple) {
   std::cout << "HOWDY:\n" << finalCircuit->toString() << "\n";
 }
 
+TEST(QiteWorkflowTester, checkTomographyMethods) {
+  using namespace qcor;
+  auto observable = 0.5 * X(0) * X(1) + 0.3 * Z(0) + 0.2 * Y(1);
+  xacc::internal_compiler::qpu = xacc::getAccelerator("qpp");
+  auto problemModel = qsim::ModelBuilder::createModel(&observable);
+  std::vector<double> energies;
+  for (const std::string tomography : {"pauli", "state-vector"}) {
+    auto workflow = qsim::getWorkflow("qite", {{"steps", 5},
+                                               {"step-size", 0.1},
+                                               {"tomography", tomography}});
+    auto result = workflow->execute(problemModel);
+    energies.emplace_back(result.get<double>("energy"));
+  }
+  // A configured evaluator selects the "pauli" tomography by default.
+  auto evaluatorResult =
+      qsim::getWorkflow("qite", {{"steps", 5},
+                                 {"step-size", 0.1},
+                                 {"evaluator", std::string("default")}})
+          ->execute(problemModel);
+  EXPECT_NEAR(evaluatorResult.get<double>("energy"), energies[0], 1e-6);
+  // Shared-basis measurements (sampling)
+  xacc::internal_compiler::qpu =
+      xacc::getAccelerator("qpp", {std::make_pair("shots", 100000)});
+  auto workflow =
+      qsim::getWorkflow("qite", {{"steps", 5}, {"step-size", 0.1}});
+  auto result = workflow->execute(problemModel);
+  EXPECT_NEAR(energies[0], energies[1], 1e-6);
+  EXPECT_NEAR(result.get<double>("energy"), energies[0], 0.05);
+}
+
+TEST(QiteWorkflowTester, checkCheckpointResume) {
+  using namespace qcor;
+  auto observable = 0.7071067811865475 * X(0) + 0.7071067811865475 * Z(0);
+  xacc::internal_compiler::qpu = xacc::getAccelerator("qpp");
+  auto problemModel = qsim::ModelBuilder::createModel(&observable);
+  const std::string checkpointFile = "qite_checkpoint_test.bin";
+  auto fullRun = qsim::getWorkflow("qite", {{"steps", 6}, {"step-size", 0.1}})
+                     ->execute(problemModel);
+  // The last step is always checkpointed.
+  qsim::getWorkflow("qite", {{"steps", 3},
+                             {"step-size", 0.1},
+                             {"checkpoint", checkpointFile},
+                             {"checkpoint-interval", 2}})
+      ->execute(problemModel);
+  auto checkpoint = qsim::WorkflowCheckpoint::load(checkpointFile, "qite");
+  EXPECT_EQ(checkpoint.getStrings("approx-ops").size(), 3);
+  EXPECT_EQ(checkpoint.getValues("energies").size(), 4);
+
+  // Resume for the last 3 steps.
+  auto resumed = qsim::getWorkflow("qite", {{"steps", 6},
+                                            {"step-size", 0.1},
+                                            {"resume-from", checkpointFile}})
+                     ->execute(problemModel);
+  const auto expected = fullRun.get<std::vector<double>>("exp-vals");
+  const auto energies = resumed.get<std::vector<double>>("exp-vals");
+  EXPECT_EQ(energies.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(energies[i], expected[i], 1e-9);
+  }
+  std::remove(checkpointFile.c_str());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,43 @@
+#include "qcor.hpp"
+#include "qcor_qsim.hpp"
+#include "xacc.hpp"
+#include <gtest/gtest.h>
+
+TEST(TimeDependentWorkflowTester, checkIncremental) {
+  using namespace qcor;
+  xacc::internal_compiler::qpu = xacc::getAccelerator("qpp");
+  // Time-dependent Hamiltonian (non-commuting terms)
+  qsim::TdObservable H = [](double t) {
+    const double Jz = 2 * M_PI * 2.86265 * 1e-3;
+    const double epsilon = Jz;
+    const double omega = 4.8 * 2 * M_PI * 1e-3;
+    return -Jz * Z(0) * Z(1) - Jz * Z(1) * Z(2) +
+           (-epsilon * std::cos(omega * t)) * (X(0) + X(1) + X(2));
+  };
+  // Observable = average magnetization
+  auto observable = (1.0 / 3.0) * (Z(0) + Z(1) + Z(2));
+  auto problemModel = qsim::ModelBuilder::createModel(&observable, H);
+  const int nbSteps = 20;
+  std::vector<std::vector<double>> expVals;
+  for (const bool incremental : {false, true}) {
+    auto workflow = qsim::getWorkflow("td-evolution", {{"dt", 3.0},
+                                                       {"steps", nbSteps},
+                                                       {"incremental",
+                                                        incremental}});
+    auto result = workflow->execute(problemModel);
+    expVals.emplace_back(result.get<std::vector<double>>("exp-vals"));
+  }
+  EXPECT_EQ(expVals[0].size(), nbSteps + 1);
+  EXPECT_EQ(expVals[0].size(), expVals[1].size());
+  for (size_t i = 0; i < expVals[0].size(); ++i) {
+    EXPECT_NEAR(expVals[0][i], expVals[1][i], 1e-6);
+  }
+}
+
+int main(int argc, char **argv) {
+  xacc::Initialize();
+  ::testing::InitGoogleTest(&argc, argv);
+  auto ret = RUN_ALL_TESTS();
+  xacc::Finalize();
+  return ret;
+}
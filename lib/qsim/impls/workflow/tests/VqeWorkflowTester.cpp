@@ -1,5 +1,6 @@
 #include "qcor.hpp"
 #include "qcor_qsim.hpp"
+#include "utils/qsim_utils.hpp"
 #include "xacc.hpp"
 #include <gtest/gtest.h>
 
@@ -28,6 +29,45 @@ TEST(VqeWorkflowTest, checkInputComposite) {
   EXPECT_NEAR(energy, -1.748, 0.1);
 }
 
+TEST(VqeWorkflowTest, checkCheckpointResume) {
+  using namespace qcor;
+  xacc::internal_compiler::qpu = xacc::getAccelerator("qpp");
+  auto xasm = xacc::getCompiler("xasm");
+  auto tmp = xasm->compile(R"#(__qpu__ void ansatz_resume(qbit q, double theta) {
+  X(q[0]);
+  exp_i_theta(q, theta, {{"pauli", "X0 Y1 - Y0 X1"}});
+  }
+)#");
+  auto kernel = tmp->getComposites()[0];
+  auto H = 5.907 - 2.1433 * X(0) * X(1) - 2.143 * Y(0) * Y(1) + 0.21829 * Z(0) -
+           6.125 * Z(1);
+  auto problemModel = qsim::ModelBuilder::createModel(kernel, H);
+  const std::string checkpointFile = "vqe_checkpoint_test.bin";
+  auto result = qsim::getWorkflow("vqe", {{"optimizer", createOptimizer("nlopt")},
+                                          {"checkpoint", checkpointFile}})
+                    ->execute(problemModel);
+  // Checkpoint after every evaluation: holds the best point.
+  auto checkpoint = qsim::WorkflowCheckpoint::load(checkpointFile, "vqe");
+  const int nbEvals = checkpoint.getValues("evaluations")[0];
+  EXPECT_GT(nbEvals, 0);
+  EXPECT_NEAR(checkpoint.getValues("best-energy")[0],
+              result.get<double>("energy"), 1e-6);
+  EXPECT_EQ(checkpoint.getValues("best-params").size(), 1);
+
+  // Resuming starts from the best point and continues the evaluation count.
+  auto resumed =
+      qsim::getWorkflow("vqe", {{"optimizer", createOptimizer("nlopt")},
+                                {"checkpoint", checkpointFile},
+                                {"resume-from", checkpointFile}})
+          ->execute(problemModel);
+  EXPECT_NEAR(resumed.get<double>("energy"), result.get<double>("energy"),
+              1e-3);
+  EXPECT_GT(qsim::WorkflowCheckpoint::load(checkpointFile, "vqe")
+                .getValues("evaluations")[0],
+            nbEvals);
+  std::remove(checkpointFile.c_str());
+}
+
 int main(int argc, char **argv) {
   xacc::Initialize();
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,4 +1,5 @@
 #include "time_dependent.hpp"
+#include "qcor_state_vector.hpp"
 #include "qsim_utils.hpp"
 #include "xacc_service.hpp"
 
@@ -17,6 +18,12 @@ bool TimeDependentWorkflow::initialize(const HeterogeneousMap &params) {
   }
 
   t_final = nbSteps * dt;
+  // Incremental mode: keep the state-vector between time steps
+  // and only apply the new Trotter step (local simulation only).
+  incremental = false;
+  if (params.keyExists<bool>("incremental")) {
+    incremental = params.get<bool>("incremental");
+  }
   config_params = params;
   return true;
 }
@@ -34,23 +41,68 @@ TimeDependentWorkflow::execute(const QuantumSimulationModel &model) {
   // Just support Trotter for now
   // TODO: support different methods:
   auto method = xacc::getService<AnsatzGenerator>("trotter");
+  auto pauli_obs = dynamic_cast<PauliOperator *>(model.observable);
+  if (incremental && !pauli_obs) {
+    xacc::error("Incremental time-dependent evolution requires a Pauli "
+                "observable.");
+  }
+  if (incremental) {
+    // The incremental mode is an exact, noiseless local simulation: it does
+    // not use the evaluator nor the accelerator (shots, noise).
+    if (config_params.pointerLikeExists<CostFunctionEvaluator>("evaluator") ||
+        config_params.stringExists("evaluator")) {
+      xacc::error("Incremental time-dependent evolution computes exact "
+                  "expectation values and cannot be used with an evaluator.");
+    }
+    auto qpu = xacc::internal_compiler::get_qpu();
+    if (qpu && (qpu->name() != "qpp" || ::quantum::get_shots() > 0)) {
+      xacc::warning("Incremental time-dependent evolution uses a local "
+                    "noiseless state-vector simulation, accelerator '" +
+                    qpu->name() + "' (shots, noise) is not used.");
+    }
+  }
+  HeterogeneousMap trotter_params{{"dt", dt}};
+  if (config_params.keyExists<int>("order")) {
+    trotter_params.insert("order", config_params.get<int>("order"));
+  }
+  if (config_params.keyExists<bool>("group-terms")) {
+    trotter_params.insert("group-terms", config_params.get<bool>("group-terms"));
+  }
+  std::shared_ptr<StateVector> state;
   for (;;) {
     // Evaluate the time-dependent Hamiltonian:
     auto ham_t = ham_func(currentTime);
-    auto stepAnsatz = method->create_ansatz(&ham_t, {{"dt", dt}});
+    auto stepAnsatz = method->create_ansatz(&ham_t, trotter_params);
     // std::cout << "t = " << currentTime << "\n";
     // std::cout << stepAnsatz.circuit->toString() << "\n";
-    // First step:
-    if (!totalCirc) {
-      totalCirc = stepAnsatz.circuit;
+    if (incremental) {
+      // Propagate the persistent state by the new step only,
+      // the expectation is computed exactly from the state-vector.
+      const size_t nbStepQubits =
+          StateVector::required_qubits(stepAnsatz.circuit);
+      if (!state) {
+        state = std::make_shared<StateVector>(
+            std::max<size_t>({(size_t)model.observable->nBits(),
+                              (size_t)ham_t.nBits(), nbStepQubits}));
+      } else if (nbStepQubits > state->n_qubits()) {
+        xacc::error("Trotter step at t = " + std::to_string(currentTime) +
+                    " acts on more qubits than the initial state.");
+      }
+      state->apply(stepAnsatz.circuit);
+      resultExpectationValues.emplace_back(state->expectation(*pauli_obs));
     } else {
-      // Append Trotter steps
-      totalCirc->addInstructions(stepAnsatz.circuit->getInstructions());
+      // First step:
+      if (!totalCirc) {
+        totalCirc = stepAnsatz.circuit;
+      } else {
+        // Append Trotter steps
+        totalCirc->addInstructions(stepAnsatz.circuit->getInstructions());
+      }
+      // std::cout << totalCirc->toString() << "\n";
+      // Evaluate the expectation after these Trotter steps:
+      const double ham_expect = evaluator->evaluate(totalCirc);
+      resultExpectationValues.emplace_back(ham_expect);
     }
-    // std::cout << totalCirc->toString() << "\n";
-    // Evaluate the expectation after these Trotter steps:
-    const double ham_expect = evaluator->evaluate(totalCirc);
-    resultExpectationValues.emplace_back(ham_expect);
 
     currentTime += dt;
     if (currentTime > t_final) {
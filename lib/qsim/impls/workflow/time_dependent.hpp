@@ -18,6 +18,7 @@ private:
   double t_0;
   double t_final;
   double dt;
+  bool incremental;
   TdObservable ham_func;
 };
 } // namespace qsim
@@ -1,5 +1,6 @@
 #include "vqe.hpp"
 #include "qsim_utils.hpp"
+#include <limits>
 
 namespace qcor {
 namespace qsim {
@@ -13,6 +14,7 @@ bool VqeWorkflow::initialize(const HeterogeneousMap &params) {
     optimizer = createOptimizer(DEFAULT_OPTIMIZER);
   }
   config_params = params;
+  checkpoint_options = CheckpointOptions::fromParams(params);
   // VQE workflow requires an optimizer
   return (optimizer != nullptr);
 }
@@ -24,10 +26,72 @@ VqeWorkflow::execute(const QuantumSimulationModel &model) {
     auto nParams = model.user_defined_ansatz->nParams();
     evaluator = getEvaluator(model.observable, config_params);
 
+    // Multi-start optimization from random initial points
+    if (config_params.keyExists<int>("starts")) {
+      if (!checkpoint_options.file.empty() ||
+          !checkpoint_options.resume_from.empty()) {
+        xacc::error("VQE workflow: 'checkpoint' and 'resume-from' are not "
+                    "supported with multi-start optimization ('starts').");
+      }
+      // Accelerator executions are not thread-safe: the starts always run
+      // sequentially, each with its own evaluator.
+      auto multiStartParams = config_params;
+      if (multiStartParams.keyExists<bool>("parallel") &&
+          multiStartParams.get<bool>("parallel")) {
+        xacc::warning("VQE workflow: 'parallel' is not supported (shared "
+                      "accelerator). Running starts sequentially.");
+        multiStartParams.insert("parallel", false);
+      }
+      auto objective_factory = [&](size_t start_idx) {
+        auto start_evaluator =
+            (start_idx == 0) ? evaluator
+                             : getEvaluator(model.observable, config_params);
+        return [&, start_evaluator](const std::vector<double> &x,
+                                    std::vector<double> &dx) {
+          auto kernel = model.user_defined_ansatz->evaluate_kernel(x);
+          return start_evaluator->evaluate(kernel);
+        };
+      };
+      return multiStartResult(multiStartOptimize(
+          optimizer, nParams, objective_factory, multiStartParams));
+    }
+
+    // Optimizer internals are not accessible: the checkpoint holds the best
+    // point found so far, which is the starting point of a resumed run.
+    int nbEvals = 0;
+    double bestEnergy = std::numeric_limits<double>::max();
+    std::vector<double> bestParams;
+    if (!checkpoint_options.resume_from.empty()) {
+      const auto checkpoint =
+          WorkflowCheckpoint::load(checkpoint_options.resume_from, name());
+      bestParams = checkpoint.getValues("best-params");
+      if (bestParams.size() != nParams) {
+        xacc::error("VQE checkpoint " + checkpoint_options.resume_from +
+                    " has " + std::to_string(bestParams.size()) +
+                    " parameters, expected " + std::to_string(nParams));
+      }
+      bestEnergy = checkpoint.getValues("best-energy")[0];
+      nbEvals = checkpoint.getValues("evaluations")[0];
+      optimizer->appendOption("initial-parameters", bestParams);
+    }
+
     OptFunction f(
         [&](const std::vector<double> &x, std::vector<double> &dx) {
           auto kernel = model.user_defined_ansatz->evaluate_kernel(x);
           auto energy = evaluator->evaluate(kernel);
+          ++nbEvals;
+          if (energy < bestEnergy) {
+            bestEnergy = energy;
+            bestParams = x;
+          }
+          // No fixed number of evaluations: save every interval.
+          if (checkpoint_options.isDue(nbEvals, 0)) {
+            WorkflowCheckpoint checkpoint(name());
+            checkpoint.setValues("evaluations", {(double)nbEvals});
+            checkpoint.setValues("best-energy", {bestEnergy});
+            checkpoint.setValues("best-params", bestParams);
+            checkpoint.save(checkpoint_options.file);
+          }
           return energy;
         },
         nParams);
@@ -1,5 +1,6 @@
 #pragma once
 #include "qcor_qsim.hpp"
+#include "qsim_utils.hpp"
 
 namespace qcor {
 namespace qsim {
@@ -16,6 +17,7 @@ public:
 private:
   std::shared_ptr<Optimizer> optimizer;
   HeterogeneousMap config_params;
+  CheckpointOptions checkpoint_options;
 };
 } // namespace qsim
 } // namespace qcor
\ No newline at end of file
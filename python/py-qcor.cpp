@@ -18,6 +18,8 @@
 #include "xacc_internal_compiler.hpp"
 #include "xacc_service.hpp"
 
+#include <deque>
+
 namespace py = pybind11;
 using namespace xacc;
 
@@ -78,6 +80,58 @@ class KernelArgDictToHeterogeneousMap {
   }
 };
 
+// Packs Python kernel args as a buffer of pointers to typed values
+// (QJIT packed-args fast path, no HetMap marshalling). Only the plain
+// kernel arg types are supported, pack() returns false otherwise.
+class PackedKernelArgs {
+ protected:
+  // deque: stable addresses
+  std::deque<int> ints;
+  std::deque<double> doubles;
+  std::deque<std::vector<int>> int_vecs;
+  std::deque<std::vector<double>> double_vecs;
+  std::vector<void *> ptrs;
+
+ public:
+  bool pack(const std::vector<std::string> &arg_types, py::list args) {
+    if (arg_types.size() != args.size()) {
+      return false;
+    }
+    for (std::size_t i = 0; i < arg_types.size(); i++) {
+      auto type = arg_types[i];
+      // Reference args bind to the packed value directly.
+      if (!type.empty() && type.back() == '&') {
+        type.pop_back();
+      }
+      py::handle arg = args[i];
+      try {
+        if (type == "qreg") {
+          ptrs.push_back(&arg.cast<xacc::internal_compiler::qreg &>());
+        } else if (type == "double") {
+          doubles.push_back(arg.cast<double>());
+          ptrs.push_back(&doubles.back());
+        } else if (type == "int") {
+          ints.push_back(arg.cast<int>());
+          ptrs.push_back(&ints.back());
+        } else if (type == "std::vector<double>") {
+          double_vecs.push_back(arg.cast<std::vector<double>>());
+          ptrs.push_back(&double_vecs.back());
+        } else if (type == "std::vector<int>") {
+          int_vecs.push_back(arg.cast<std::vector<int>>());
+          ptrs.push_back(&int_vecs.back());
+        } else {
+          return false;
+        }
+      } catch (py::cast_error &e) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void **data() { return ptrs.data(); }
+};
+
 // Add type name to this list to support receiving from Python.
 using PyHeterogeneousMapTypes =
     xacc::Variant<bool, int, double, std::string,
@@ -462,8 +516,24 @@ PYBIND11_MODULE(_pyqcor, m) {
           "");
   // m.def("createObjectiveFunction", [](const std::string name, ))
   py::class_<qcor::QJIT, std::shared_ptr<qcor::QJIT>>(m, "QJIT", "")
-      .def(py::init<>(), "")
+      .def(py::init<bool, int>(), py::arg("lazy") = false,
+           py::arg("opt_level") = -1, "")
       .def("write_cache", &qcor::QJIT::write_cache, "")
+      .def(
+          "cache_stats",
+          [](qcor::QJIT &qjit) {
+            const auto &stats = qjit.cache_stats();
+            py::dict d;
+            d["hits"] = stats.hits;
+            d["object_hits"] = stats.object_hits;
+            d["misses"] = stats.misses;
+            d["evictions"] = stats.evictions;
+            d["compile_time_ms"] = stats.compile_time_ms;
+            d["optimize_time_ms"] = stats.optimize_time_ms;
+            d["load_time_ms"] = stats.load_time_ms;
+            return d;
+          },
+          "Return the kernel cache statistics.")
       .def(
           "jit_compile",
           [](qcor::QJIT &qjit, const std::string src) {
@@ -481,6 +551,27 @@ PYBIND11_MODULE(_pyqcor, m) {
                              extra_cpp_code, extra_headers);
           },
           "")
+      .def(
+          "jit_compile_many",
+          [](qcor::QJIT &qjit, const std::vector<std::string> &srcs,
+             int nb_threads) {
+            bool turn_on_hetmap_kernel_ctor = true;
+            qjit.jit_compile_many(srcs, turn_on_hetmap_kernel_ctor, "", {},
+                                  nb_threads);
+          },
+          py::arg("srcs"), py::arg("nb_threads") = 0,
+          "Compile independent kernels concurrently.")
+      .def("specialize", &qcor::QJIT::specialize, py::arg("kernel_name"),
+           py::arg("arg_values"),
+           "Create a variant of a kernel with constant-folded arguments "
+           "(argument index -> value), returns the variant name.")
+      .def(
+          "invoke_specialized",
+          [](qcor::QJIT &qjit, const std::string name,
+             xacc::internal_compiler::qreg &q) { qjit.invoke(name, q); },
+          py::arg("name"), py::arg("q"),
+          "Invoke a kernel variant whose only remaining argument is the "
+          "qreg (see specialize).")
       .def(
           "run_syntax_handler",
           [](qcor::QJIT &qjit, const std::string src) {
@@ -499,6 +590,34 @@ PYBIND11_MODULE(_pyqcor, m) {
           },
           "")
           
+      .def(
+          "invoke_packed",
+          [](qcor::QJIT &qjit, const std::string name,
+             const std::vector<std::string> &arg_types, py::list args) {
+            PackedKernelArgs packed;
+            if (!packed.pack(arg_types, args)) {
+              return false;
+            }
+            return qjit.invoke_with_packed_args(name, packed.data());
+          },
+          py::arg("name"), py::arg("arg_types"), py::arg("args"),
+          "Invoke the kernel through its typed packed-args entry point. "
+          "Return False if the args can't be packed (use invoke).")
+      .def(
+          "extract_composite_packed",
+          [](qcor::QJIT &qjit, const std::string name,
+             const std::vector<std::string> &arg_types, py::list args)
+              -> std::shared_ptr<xacc::CompositeInstruction> {
+            PackedKernelArgs packed;
+            if (!packed.pack(arg_types, args)) {
+              return nullptr;
+            }
+            return qjit.extract_composite_with_packed_args(name,
+                                                           packed.data());
+          },
+          py::arg("name"), py::arg("arg_types"), py::arg("args"),
+          "Extract the kernel composite through its typed packed-args entry "
+          "point. Return None if the args can't be packed.")
       .def("extract_composite",
            [](qcor::QJIT &qjit, const std::string name, KernelArgDict args) {
              xacc::HeterogeneousMap m;
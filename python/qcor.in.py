@@ -318,14 +318,18 @@ class qjit(object):
         cpp_arg_str = ''
         self.ref_type_args = []
         self.qRegName = ''
+        # C++ arg types, in the kernel signature order (packed-args invocation)
+        self.cpp_arg_types = []
         for arg, _type in self.type_annotations.items():
             if _type is FLOAT_REF:
                 self.ref_type_args.append(arg)
+                self.cpp_arg_types.append('double&')
                 cpp_arg_str += ',' + \
                     'double& ' + arg
                 continue
             if _type is INT_REF:
                 self.ref_type_args.append(arg)
+                self.cpp_arg_types.append('int&')
                 cpp_arg_str += ',' + \
                     'int& ' + arg
                 continue
@@ -334,6 +338,7 @@ class qjit(object):
                 exit(1)
             if self.allowed_type_cpp_map[str(_type)] == 'qreg':
                 self.qRegName = arg
+            self.cpp_arg_types.append(self.allowed_type_cpp_map[str(_type)])
             cpp_arg_str += ',' + \
                 self.allowed_type_cpp_map[str(_type)] + ' ' + arg
         cpp_arg_str = cpp_arg_str[1:]
@@ -483,6 +488,11 @@ class qjit(object):
         """
         Convert the quantum kernel into an XACC CompositeInstruction
         """
+        # Typed fast path: pass the args as a packed buffer
+        composite = self._qjit.extract_composite_packed(
+            self.function.__name__, self.cpp_arg_types, list(args))
+        if composite is not None:
+            return composite
         # Create a dictionary for the function arguments
         args_dict = {}
         for i, arg_name in enumerate(self.arg_names):
@@ -538,19 +548,20 @@ class qjit(object):
         Execute the decorated quantum kernel. This will directly 
         invoke the corresponding LLVM JITed function pointer. 
         """
-        # Create a dictionary for the function arguments
-        args_dict = {}
-        for i, arg_name in enumerate(self.arg_names):
-            args_dict[arg_name] = list(args)[i]
-
-        # Invoke the JITed function
-        self._qjit.invoke(self.function.__name__, args_dict)
+        # Invoke the JITed function, through the typed packed-args
+        # entry point if the args allow it (no HetMap marshalling)
+        if not self._qjit.invoke_packed(self.function.__name__, self.cpp_arg_types, list(args)):
+            # Create a dictionary for the function arguments
+            args_dict = {}
+            for i, arg_name in enumerate(self.arg_names):
+                args_dict[arg_name] = list(args)[i]
+            self._qjit.invoke(self.function.__name__, args_dict)
 
         # Update any *by-ref* arguments: annotated with the custom type: FLOAT_REF, INT_REF, etc.
         # If there are *pass-by-ref* variables:
         if len(self.ref_type_args) > 0:
             # Access the register:
-            qReg = args_dict[self.qRegName]
+            qReg = args[self.arg_names.index(self.qRegName)]
             # Retrieve *original* variable names of the argument pack
             frame = inspect.currentframe()
             frame = inspect.getouterframes(frame)[1]
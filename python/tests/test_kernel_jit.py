@@ -2,6 +2,8 @@ import unittest
 from qcor import *
 # Import Python math with alias
 import math as myMathMod
+import math
+import uuid
 
 # Some global variables for testing
 MY_PI = 3.1416
@@ -519,5 +521,134 @@ class TestKernelJIT(unittest.TestCase):
         self.assertEqual(comp2.getInstruction(1).name(), "Z") 
         self.assertEqual(comp3.getInstruction(1).name(), "T") 
 
+    # Kernel source as generated by @qjit: X on the first n qubits, Ry(theta)
+    # on the next one, then measure all.
+    def qjit_src(self, name):
+        return '__qpu__ void ' + name + '(qreg q, int n, double theta) {\n' + \
+            'using qcor::pyxasm;\n' + \
+            'for i in range(n):\n' + \
+            '    X(q[i])\n' + \
+            'Ry(q[n], theta)\n' + \
+            'for i in range(q.size()):\n' + \
+            '    Measure(q[i])\n' + \
+            '}\n'
+
+    def test_jit_cache_stats(self):
+        set_qpu('qpp', {'shots':1024})
+        # Unique kernel: never seen by the cache
+        name = 'jit_stats_' + uuid.uuid4().hex
+        src = self.qjit_src(name)
+        jit = QJIT()
+        jit.jit_compile(src)
+        jit.write_cache()
+        stats = jit.cache_stats()
+        self.assertEqual(stats['misses'], 1)
+        self.assertEqual(stats['hits'], 0)
+
+        # Second engine: served from the cached native object
+        cached_jit = QJIT()
+        cached_jit.jit_compile(src)
+        stats = cached_jit.cache_stats()
+        self.assertEqual(stats['misses'], 0)
+        self.assertEqual(stats['hits'], 1)
+        self.assertEqual(stats['object_hits'], 1)
+        q = qalloc(3)
+        cached_jit.invoke(name, {'q': q, 'n': 2, 'theta': math.pi})
+        self.assertEqual(q.counts()['111'], 1024)
+
+    def test_jit_compile_many(self):
+        set_qpu('qpp', {'shots':1024})
+        names = ['jit_many_' + str(i) + '_' + uuid.uuid4().hex for i in range(2)]
+        jit = QJIT()
+        jit.jit_compile_many([self.qjit_src(name) for name in names], 2)
+        stats = jit.cache_stats()
+        self.assertEqual(stats['misses'], len(names))
+        # All zeros, then all ones
+        for name, n, theta, expected in zip(names, [0, 2], [0.0, math.pi],
+                                            ['000', '111']):
+            q = qalloc(3)
+            jit.invoke(name, {'q': q, 'n': n, 'theta': theta})
+            self.assertEqual(q.counts()[expected], 1024)
+
+    def test_jit_lazy(self):
+        set_qpu('qpp', {'shots':1024})
+        name = 'jit_lazy_' + uuid.uuid4().hex
+        jit = QJIT(lazy=True)
+        jit.jit_compile(self.qjit_src(name))
+        # Compiled to native code on this first invocation
+        q = qalloc(3)
+        jit.invoke(name, {'q': q, 'n': 2, 'theta': math.pi})
+        self.assertEqual(q.counts()['111'], 1024)
+        comp = jit.extract_composite(name, {'q': q, 'n': 1, 'theta': 0.5})
+        self.assertEqual(comp.nInstructions(), 5)
+
+    def test_jit_specialize(self):
+        set_qpu('qpp', {'shots':1024})
+        name = 'jit_spec_' + uuid.uuid4().hex
+        jit = QJIT()
+        jit.jit_compile(self.qjit_src(name))
+        # LLVM IR argument indices: the qreg (passed indirectly) is #0
+        variant = jit.specialize(name, {1: 2, 2: math.pi})
+        self.assertNotEqual(variant, name)
+        self.assertEqual(jit.specialize(name, {1: 2, 2: math.pi}), variant)
+        q = qalloc(3)
+        jit.invoke(name, {'q': q, 'n': 2, 'theta': math.pi})
+        q_spec = qalloc(3)
+        jit.invoke_specialized(variant, q_spec)
+        self.assertEqual(q.counts(), q_spec.counts())
+        self.assertEqual(q_spec.counts()['111'], 1024)
+
+    def test_jit_opt_level(self):
+        set_qpu('qpp', {'shots':1024})
+        name = 'jit_opt_' + uuid.uuid4().hex
+        src = self.qjit_src(name)
+        jit = QJIT(opt_level=0)
+        jit.jit_compile(src)
+        opt_jit = QJIT(opt_level=2)
+        opt_jit.jit_compile(src)
+        for n, theta in [(0, 0.0), (1, 0.3), (2, math.pi)]:
+            args = {'q': qalloc(3), 'n': n, 'theta': theta}
+            comp = jit.extract_composite(name, args)
+            opt_comp = opt_jit.extract_composite(name, args)
+            self.assertEqual(comp.toString(), opt_comp.toString())
+        q = qalloc(3)
+        opt_jit.invoke(name, {'q': q, 'n': 2, 'theta': math.pi})
+        self.assertEqual(q.counts()['111'], 1024)
+
+    def test_packed_hetmap_parity(self):
+        @qjit
+        def packed_parity(q : qreg, theta : float, angles : List[float], out : FLOAT_REF):
+            Ry(q[0], theta)
+            for angle in angles:
+                Rz(q[1], angle)
+            out = 2.0 * theta + angles[0]
+
+        self.assertEqual(packed_parity.cpp_arg_types,
+                         ['qreg', 'double', 'std::vector<double>', 'double&'])
+        jit = packed_parity._qjit
+        name = packed_parity.kernel_name()
+        args = [0.5, [0.1, 0.2]]
+        arg_dict = {'theta': args[0], 'angles': args[1], 'out': 0.0}
+
+        q_packed = qalloc(2)
+        self.assertTrue(jit.invoke_packed(name, packed_parity.cpp_arg_types,
+                                          [q_packed] + args + [0.0]))
+        q_hetmap = qalloc(2)
+        jit.invoke(name, dict(arg_dict, q=q_hetmap))
+        self.assertAlmostEqual(q_packed.getInformation('out'), 1.1)
+        self.assertAlmostEqual(q_hetmap.getInformation('out'),
+                               q_packed.getInformation('out'))
+
+        q = qalloc(2)
+        comp_packed = jit.extract_composite_packed(
+            name, packed_parity.cpp_arg_types, [q] + args + [0.0])
+        comp_hetmap = jit.extract_composite(name, dict(arg_dict, q=q))
+        self.assertEqual(comp_packed.nInstructions(), 3)
+        self.assertEqual(comp_packed.toString(), comp_hetmap.toString())
+
+        # Unsupported arg types are not packed (falls back to the HetMap).
+        self.assertFalse(jit.invoke_packed(name, ['qreg', 'qcor::PauliOperator'],
+                                           [q, X(0)]))
+
 if __name__ == '__main__':
   unittest.main()
\ No newline at end of file
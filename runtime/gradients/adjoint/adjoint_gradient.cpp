@@ -0,0 +1,169 @@
+#include "qcor.hpp"
+#include "qcor_state_vector.hpp"
+
+#include "cppmicroservices/BundleActivator.h"
+#include "cppmicroservices/BundleContext.h"
+#include "cppmicroservices/ServiceProperties.h"
+using namespace cppmicroservices;
+
+#include "AlgorithmGradientStrategy.hpp"
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+#include "xacc_plugin.hpp"
+
+namespace qcor {
+
+// Adjoint-method gradient strategy for state-vector simulation.
+// The gradient w.r.t. every gate angle is computed from one forward
+// pass and one backward sweep:
+//   |psi> = U_N...U_1|0>, |lambda> = H|psi>
+//   for g = N..1: |psi> = U_g^dag|psi>,
+//                 dE/dtheta_g = 2 Re <lambda| dU_g/dtheta_g |psi>,
+//                 |lambda> = U_g^dag|lambda>
+// Gate angles are then mapped back to the optimizer parameters x via
+// the (classical) Jacobian d(theta)/dx of the kernel evaluation.
+//
+// No circuits are returned by getGradientExecutions(), all work is
+// performed in compute().
+class AdjointGradient : public xacc::AlgorithmGradientStrategy {
+protected:
+  using KernelEvaluator =
+      std::function<std::shared_ptr<CompositeInstruction>(std::vector<double>)>;
+
+  std::shared_ptr<Observable> observable;
+  KernelEvaluator kernel_evaluator;
+  std::shared_ptr<CompositeInstruction> circuit;
+  std::vector<double> current_parameters;
+  // Step size for the central-difference Jacobian d(theta)/dx
+  double jacobian_step = 1e-4;
+
+  std::shared_ptr<CompositeInstruction>
+  evaluate_circuit(const std::vector<double> &x) {
+    if (kernel_evaluator) {
+      return kernel_evaluator(x);
+    }
+    if (circuit->nVariables() > 0) {
+      return circuit->operator()(x);
+    }
+    xacc::error("Adjoint Gradient Error - cannot evaluate the circuit at new "
+                "parameters, please provide a kernel-evaluator.");
+    return nullptr;
+  }
+
+  static std::vector<double>
+  gate_angles(const std::vector<std::shared_ptr<xacc::Instruction>> &insts) {
+    std::vector<double> angles;
+    for (auto &inst : insts) {
+      for (int i = 0; i < inst->nParameters(); i++) {
+        angles.emplace_back(
+            xacc::InstructionParameterToDouble(inst->getParameter(i)));
+      }
+    }
+    return angles;
+  }
+
+public:
+  bool initialize(const HeterogeneousMap parameters) override {
+    if (!parameters.pointerLikeExists<Observable>("observable")) {
+      xacc::error("Adjoint Gradient Error - observable is required.");
+      return false;
+    }
+    observable = xacc::as_shared_ptr(
+        parameters.getPointerLike<Observable>("observable"));
+
+    kernel_evaluator = nullptr;
+    if (parameters.keyExists<KernelEvaluator>("kernel-evaluator")) {
+      kernel_evaluator = parameters.get<KernelEvaluator>("kernel-evaluator");
+    }
+
+    if (parameters.keyExists<double>("adjoint-jacobian-step")) {
+      jacobian_step = parameters.get<double>("adjoint-jacobian-step");
+    }
+    return true;
+  }
+
+  std::vector<std::shared_ptr<CompositeInstruction>>
+  getGradientExecutions(std::shared_ptr<CompositeInstruction> in_circuit,
+                        const std::vector<double> &x) override {
+    circuit = in_circuit;
+    current_parameters = x;
+    return {};
+  }
+
+  void compute(std::vector<double> &dx,
+               std::vector<std::shared_ptr<xacc::AcceleratorBuffer>>
+                   results) override {
+    auto pauli = std::dynamic_pointer_cast<PauliOperator>(observable);
+    if (!pauli) {
+      xacc::error("Adjoint Gradient Error - only Pauli observables are "
+                  "supported.");
+    }
+
+    auto program = evaluate_circuit(current_parameters);
+    auto insts = StateVector::flatten(program);
+    for (auto &inst : insts) {
+      if (!StateVector::is_supported(inst)) {
+        xacc::error("Adjoint Gradient Error - unsupported gate " +
+                    inst->name());
+      }
+    }
+
+    const auto n_qubits = std::max<std::size_t>(
+        StateVector::required_qubits(program), observable->nBits());
+
+    // Forward pass
+    StateVector psi(n_qubits);
+    for (auto &inst : insts) {
+      psi.apply(inst);
+    }
+    auto lambda = psi.apply(*pauli);
+
+    // Backward sweep, collect dE/dtheta in forward gate order
+    std::vector<std::vector<double>> gate_grads(insts.size());
+    for (int g = insts.size() - 1; g >= 0; g--) {
+      auto &inst = insts[g];
+      psi.apply_adjoint(inst);
+      for (int p = 0; p < inst->nParameters(); p++) {
+        auto mu = psi;
+        mu.apply_derivative(inst, p);
+        gate_grads[g].emplace_back(2.0 * std::real(lambda.inner(mu)));
+      }
+      lambda.apply_adjoint(inst);
+    }
+    std::vector<double> angle_grads;
+    for (auto &grads : gate_grads) {
+      angle_grads.insert(angle_grads.end(), grads.begin(), grads.end());
+    }
+
+    // Chain rule through the kernel evaluation: dE/dx = J^T dE/dtheta
+    dx.assign(current_parameters.size(), 0.0);
+    for (std::size_t i = 0; i < current_parameters.size(); i++) {
+      auto x_plus = current_parameters;
+      auto x_minus = current_parameters;
+      x_plus[i] += jacobian_step;
+      x_minus[i] -= jacobian_step;
+      const auto angles_plus =
+          gate_angles(StateVector::flatten(evaluate_circuit(x_plus)));
+      const auto angles_minus =
+          gate_angles(StateVector::flatten(evaluate_circuit(x_minus)));
+      if (angles_plus.size() != angle_grads.size() ||
+          angles_minus.size() != angle_grads.size()) {
+        xacc::error("Adjoint Gradient Error - circuit structure depends on "
+                    "the parameters.");
+      }
+      for (std::size_t k = 0; k < angle_grads.size(); k++) {
+        const auto jac =
+            (angles_plus[k] - angles_minus[k]) / (2.0 * jacobian_step);
+        dx[i] += angle_grads[k] * jac;
+      }
+    }
+  }
+
+  const std::string name() const override { return "adjoint"; }
+  const std::string description() const override {
+    return "Adjoint-method analytic gradients via state-vector simulation.";
+  }
+};
+} // namespace qcor
+
+REGISTER_PLUGIN(qcor::AdjointGradient, xacc::AlgorithmGradientStrategy)
@@ -4,10 +4,12 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "heterogeneous.hpp"
 
 namespace llvm {
+class LLVMContext;
 class Module;
 }
 namespace xacc {
@@ -16,13 +18,28 @@ class CompositeInstruction;
 
 namespace qcor {
 class LLVMJIT;
+class QJITCache;
+
+// Statistics of the QJIT kernel cache
+struct QJITCacheStats {
+  std::size_t hits = 0;
+  // Hits served by linking the cached native object (no codegen)
+  std::size_t object_hits = 0;
+  std::size_t misses = 0;
+  std::size_t evictions = 0;
+  // Time spent compiling kernels (misses)
+  double compile_time_ms = 0.0;
+  // Part of the compile time spent in the LLVM optimization pipeline
+  double optimize_time_ms = 0.0;
+  // Time spent loading cached kernels (hits)
+  double load_time_ms = 0.0;
+};
 
 class QJIT {
   template <typename... Args>
   using kernel_functor_t = void (*)(Args...);
 
  private:
-  std::map<std::size_t, std::string> cached_kernel_codes;
   std::string demangle(const char *name) {
     int status = -1;
     std::unique_ptr<char, void (*)(void *)> res{
@@ -31,17 +48,55 @@ class QJIT {
   };
 
   std::string qjit_cache_path = "";
+  std::unique_ptr<QJITCache> cache;
+  QJITCacheStats stats;
+  bool lazy_compile = false;
+  // Level (0-3) of the LLVM pipeline run on the kernel Modules
+  int opt_level = 0;
+
+  // Kernel code generated by the syntax handler, and its
+  // LLVM Module once compiled.
+  struct KernelCode {
+    std::string kernel_name;
+    std::string code;
+    std::string cache_key;
+    double compile_time_ms = 0.0;
+    double optimize_time_ms = 0.0;
+    std::unique_ptr<llvm::LLVMContext> ctx;
+    std::unique_ptr<llvm::Module> module;
+  };
+  KernelCode prepare_kernel(const std::string &quantum_kernel_src,
+                            const bool add_het_map_kernel_ctor,
+                            const std::vector<std::string> &kernel_dependency,
+                            const std::string &extra_functions_src,
+                            const std::vector<std::string> &extra_headers);
+  // Compile the kernel code to an LLVM Module (thread-safe)
+  void compile_kernel(KernelCode &kernel,
+                      const std::vector<std::string> &extra_headers);
+  // Add the kernel to the JIT (from the cache if possible) and
+  // register its function pointers.
+  void add_kernel(KernelCode &kernel, const bool add_het_map_kernel_ctor,
+                  const std::vector<std::string> &extra_headers);
 
  protected:
   std::map<std::string, std::uint64_t> kernel_name_to_f_ptr;
   std::map<std::string, std::uint64_t> kernel_name_to_f_ptr_hetmap;
   std::map<std::string, std::uint64_t> kernel_name_to_f_ptr_parent_hetmap;
+  std::map<std::string, std::uint64_t> kernel_name_to_f_ptr_packed;
+  std::map<std::string, std::uint64_t> kernel_name_to_f_ptr_parent_packed;
+  // Cache key and mangled name of the kernel functions (for specialize)
+  std::map<std::string, std::string> kernel_name_to_cache_key;
+  std::map<std::string, std::string> kernel_name_to_mangled_name;
 
   std::unique_ptr<LLVMJIT> jit;
   std::unique_ptr<llvm::Module> module;
 
  public:
-  QJIT();
+  // In lazy mode, kernel functions are only compiled to native code
+  // on their first invocation. The kernel Modules are optimized with the
+  // LLVM O<opt_level> pipeline before they are cached and linked
+  // (opt_level < 0: $QJIT_OPT_LEVEL, default 0).
+  QJIT(const bool lazy = false, const int opt_level = -1);
   ~QJIT();
   const std::pair<std::string, std::string> run_syntax_handler(
       const std::string &quantum_kernel_src,
@@ -52,7 +107,31 @@ class QJIT {
                    const std::string &extra_functions_src = "",
                    std::vector<std::string> extra_headers = {});
 
+  // Compile independent kernels concurrently (nb_threads <= 0: one thread
+  // per core). Cached kernels are loaded as in jit_compile.
+  void jit_compile_many(const std::vector<std::string> &quantum_kernel_srcs,
+                        const bool add_het_map_kernel_ctor = false,
+                        const std::string &extra_functions_src = "",
+                        std::vector<std::string> extra_headers = {},
+                        int nb_threads = 0);
+
+  // Create a variant of a compiled kernel with some of its arguments
+  // (LLVM IR argument index -> value) folded as constants, optimized at O2
+  // (i.e. loops over these arguments are unrolled). IR indices match the
+  // C++ ones for kernels taking the qreg and scalars (a class passed by
+  // value is a single pointer argument), but not for coerced aggregates.
+  // Only integer, bool and floating point arguments can be specialized.
+  // Variants are cached (in memory and on disk). Returns the name of the
+  // variant, to be invoked with the remaining arguments, e.g.
+  //   auto name = qjit.specialize("qft", {{1, 0}, {2, 8}, {3, 1}});
+  //   qjit.invoke(name, q);
+  std::string specialize(const std::string &kernel_name,
+                         const std::map<int, double> &arg_values);
+
+  // Enforce the cache size bound (entries themselves are written
+  // when they are compiled).
   void write_cache();
+  const QJITCacheStats &cache_stats() const { return stats; }
 
   template <typename... Args>
   void invoke(const std::string &kernel_name, Args... args) {
@@ -66,6 +145,14 @@ class QJIT {
   std::shared_ptr<xacc::CompositeInstruction> extract_composite_with_hetmap(
       const std::string name, xacc::HeterogeneousMap &m);
 
+  // Typed fast path (kernels compiled with the HetMap ctor): args is a
+  // buffer of pointers to the kernel arguments, in the signature order,
+  // e.g. void *args[] = {&q, &theta}. Return false if the kernel has no
+  // packed-args entry point.
+  bool invoke_with_packed_args(const std::string &kernel_name, void **args);
+  std::shared_ptr<xacc::CompositeInstruction> extract_composite_with_packed_args(
+      const std::string name, void **args);
+
   template <typename... Args>
   kernel_functor_t<Args...> get_kernel(const std::string &kernel_name) {
     auto f_ptr = kernel_name_to_f_ptr[kernel_name];
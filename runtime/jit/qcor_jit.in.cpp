@@ -23,29 +23,41 @@
 #include "clang/Lex/ModuleLoader.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
-#include "json.hpp"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IRReader/IRReader.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetSelect.h"
-#include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "qcor_clang_wrapper.hpp"
+#include "qcor_compile_server.hpp"
 #include "qcor_jit.hpp"
 #include "qcor_syntax_handler.hpp"
 #include "qrt.hpp"
@@ -55,10 +67,22 @@
 using namespace llvm;
 using namespace llvm::orc;
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <regex>
+#include <sstream>
+#include <thread>
 
 namespace qcor {
 
@@ -243,19 +267,42 @@ class LLVMJIT {
   ExecutionSession ES;
   RTDyldObjectLinkingLayer ObjectLayer;
   IRCompileLayer CompileLayer;
+  // Lazy mode: functions are compiled on their first call
+  // through lazy reexports (stubs).
+  std::unique_ptr<LazyCallThroughManager> LCTMgr;
+  std::unique_ptr<CompileOnDemandLayer> CODLayer;
 
   DataLayout DL;
   MangleAndInterner Mangle;
   ThreadSafeContext Ctx;
 
   JITDylib &MainJD;
+  bool runtime_libraries_added = false;
+
+  void addRuntimeLibraries() {
+    if (runtime_libraries_added) return;
+    // FIXME hook up to cmake
+    MainJD.addGenerator(cantFail(DynamicLibrarySearchGenerator::Load(
+        "@XACC_ROOT@/lib/libxacc@CMAKE_SHARED_LIBRARY_SUFFIX@", DL.getGlobalPrefix())));
+    MainJD.addGenerator(cantFail(DynamicLibrarySearchGenerator::Load(
+        "@CMAKE_INSTALL_PREFIX@/lib/libqrt@CMAKE_SHARED_LIBRARY_SUFFIX@", DL.getGlobalPrefix())));
+    MainJD.addGenerator(cantFail(DynamicLibrarySearchGenerator::Load(
+        "@CMAKE_INSTALL_PREFIX@/lib/libqcor@CMAKE_SHARED_LIBRARY_SUFFIX@", DL.getGlobalPrefix())));
+    MainJD.addGenerator(cantFail(DynamicLibrarySearchGenerator::Load(
+        "@XACC_ROOT@/lib/libCppMicroServices@CMAKE_SHARED_LIBRARY_SUFFIX@", DL.getGlobalPrefix())));
+    runtime_libraries_added = true;
+  }
 
  public:
-  LLVMJIT(JITTargetMachineBuilder JTMB, DataLayout DL,
+  // Compiled objects are reported to (and looked up from) the
+  // ObjectCache, if provided.
+  LLVMJIT(JITTargetMachineBuilder JTMB, DataLayout DL, ObjectCache *objCache,
+          bool lazy,
           std::unique_ptr<LLVMContext> ctx = std::make_unique<LLVMContext>())
       : ObjectLayer(ES,
                     []() { return std::make_unique<SectionMemoryManager>(); }),
-        CompileLayer(ES, ObjectLayer, ConcurrentIRCompiler(std::move(JTMB))),
+        CompileLayer(ES, ObjectLayer,
+                     ConcurrentIRCompiler(std::move(JTMB), objCache)),
         DL(std::move(DL)),
         Mangle(ES, this->DL),
         Ctx(std::move(ctx)),
@@ -264,21 +311,18 @@ class LLVMJIT {
         cantFail(DynamicLibrarySearchGenerator::GetForCurrentProcess(
             DL.getGlobalPrefix())));
     llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
-  }
-
-  static Expected<std::unique_ptr<LLVMJIT>> Create() {
-    auto JTMB = JITTargetMachineBuilder::detectHost();
-
-    if (!JTMB) return JTMB.takeError();
-
-    auto DL = JTMB->getDefaultDataLayoutForTarget();
-    if (!DL) return DL.takeError();
-
-    return std::make_unique<LLVMJIT>(std::move(*JTMB), std::move(*DL));
+    if (lazy) {
+      const llvm::Triple TT(llvm::sys::getProcessTriple());
+      LCTMgr = cantFail(createLocalLazyCallThroughManager(TT, ES, 0));
+      CODLayer = std::make_unique<CompileOnDemandLayer>(
+          ES, CompileLayer, *LCTMgr,
+          createLocalIndirectStubsManagerBuilder(TT));
+    }
   }
 
   static Expected<std::unique_ptr<LLVMJIT>> Create(
-      std::unique_ptr<LLVMContext> ctx) {
+      ObjectCache *objCache = nullptr, bool lazy = false,
+      std::unique_ptr<LLVMContext> ctx = std::make_unique<LLVMContext>()) {
     auto JTMB = JITTargetMachineBuilder::detectHost();
 
     if (!JTMB) return JTMB.takeError();
@@ -287,24 +331,30 @@ class LLVMJIT {
     if (!DL) return DL.takeError();
 
     return std::make_unique<LLVMJIT>(std::move(*JTMB), std::move(*DL),
-                                     std::move(ctx));
+                                     objCache, lazy, std::move(ctx));
   }
   const DataLayout &getDataLayout() const { return DL; }
 
   LLVMContext &getContext() { return *Ctx.getContext(); }
 
-  Error addModule(std::unique_ptr<llvm::Module> M) {
-    // FIXME hook up to cmake
-    MainJD.addGenerator(cantFail(DynamicLibrarySearchGenerator::Load(
-        "@XACC_ROOT@/lib/libxacc@CMAKE_SHARED_LIBRARY_SUFFIX@", DL.getGlobalPrefix())));
-    MainJD.addGenerator(cantFail(DynamicLibrarySearchGenerator::Load(
-        "@CMAKE_INSTALL_PREFIX@/lib/libqrt@CMAKE_SHARED_LIBRARY_SUFFIX@", DL.getGlobalPrefix())));
-    MainJD.addGenerator(cantFail(DynamicLibrarySearchGenerator::Load(
-        "@CMAKE_INSTALL_PREFIX@/lib/libqcor@CMAKE_SHARED_LIBRARY_SUFFIX@", DL.getGlobalPrefix())));
-    MainJD.addGenerator(cantFail(DynamicLibrarySearchGenerator::Load(
-        "@XACC_ROOT@/lib/libCppMicroServices@CMAKE_SHARED_LIBRARY_SUFFIX@", DL.getGlobalPrefix())));
+  // The Module lives in its own context if provided,
+  // otherwise in the JIT context.
+  Error addModule(std::unique_ptr<llvm::Module> M,
+                  std::unique_ptr<LLVMContext> ModuleCtx = nullptr) {
+    addRuntimeLibraries();
+    ThreadSafeModule TSM =
+        ModuleCtx ? ThreadSafeModule(std::move(M), std::move(ModuleCtx))
+                  : ThreadSafeModule(std::move(M), Ctx);
+    if (CODLayer) {
+      return CODLayer->add(MainJD, std::move(TSM));
+    }
+    return CompileLayer.add(MainJD, std::move(TSM));
+  }
 
-    return CompileLayer.add(MainJD, ThreadSafeModule(std::move(M), Ctx));
+  // Link an already compiled object file (no codegen)
+  Error addObject(std::unique_ptr<MemoryBuffer> Obj) {
+    addRuntimeLibraries();
+    return ObjectLayer.add(MainJD, std::move(Obj));
   }
 
   Expected<JITEvaluatedSymbol> lookup(StringRef Name) {
@@ -312,50 +362,285 @@ class LLVMJIT {
   }
 };
 
-QJIT::QJIT() {
-  // if tmp directory doesnt exist create it
-  qjit_cache_path = std::string(std::getenv("HOME")) + "/.qjit";
-  if (!xacc::directoryExists(qjit_cache_path)) {
-    auto status =
-        mkdir(qjit_cache_path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+// Content-addressed on-disk cache of the JIT-compiled kernels.
+// Each entry is a <key>.<ext> file in the cache directory, key being the SHA1
+// of the kernel code and of everything else that affects its compilation.
+// Entries are written to a temporary file then renamed (atomic), and
+// concurrent processes synchronize through an flock of the directory lock
+// file. The cache size is bounded ($QJIT_CACHE_MAX_MB, default 1024 MB) by
+// evicting the least recently used entries (the file modification time is
+// updated on every hit).
+// This is also the ORC ObjectCache of the JIT: objects compiled from a Module
+// whose identifier is a cache key are stored as <key>.o.
+class QJITCache : public ObjectCache {
+ private:
+  std::string dir;
+  std::uint64_t max_size_bytes = 1024ULL * 1024 * 1024;
+
+  // RAII flock of the cache lock file
+  class FileLock {
+    int fd = -1;
+
+   public:
+    FileLock(const std::string &lock_file, bool exclusive) {
+      fd = open(lock_file.c_str(), O_RDWR | O_CREAT, 0644);
+      if (fd >= 0) {
+        flock(fd, exclusive ? LOCK_EX : LOCK_SH);
+      }
+    }
+    ~FileLock() {
+      if (fd >= 0) {
+        flock(fd, LOCK_UN);
+        close(fd);
+      }
+    }
+  };
+
+  std::string lock_file() const { return dir + "/.lock"; }
+
+ public:
+  QJITCache(const std::string &cache_dir) : dir(cache_dir) {
+    if (!xacc::directoryExists(dir)) {
+      mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    }
+    if (const char *max_mb = std::getenv("QJIT_CACHE_MAX_MB")) {
+      max_size_bytes = std::stoull(max_mb) * 1024 * 1024;
+    }
   }
 
-  std::string cache_file_loc = qjit_cache_path + "/qjit_cache.json";
-  if (!xacc::fileExists(cache_file_loc)) {
-    // if it doesn't exist, create it
-    std::ofstream cache(cache_file_loc);
-    cache.close();
-  } else {
-    std::ifstream cache_file(cache_file_loc);
-    std::string cache_file_contents(
-        (std::istreambuf_iterator<char>(cache_file)),
-        std::istreambuf_iterator<char>());
-    if (!cache_file_contents.empty()) {
-      auto cache_json = nlohmann::json::parse(cache_file_contents);
-      auto jit_cache = cache_json["jit_cache"];
-      for (auto &element : jit_cache) {
-        auto key_val = element.get<std::pair<std::size_t, std::string>>();
-        cached_kernel_codes.insert(key_val);
+  static std::string hash(const std::string &content) {
+    const auto digest = llvm::SHA1::hash(llvm::arrayRefFromStringRef(content));
+    std::string hex;
+    for (const auto byte : digest) {
+      hex += llvm::hexdigit(byte >> 4, true);
+      hex += llvm::hexdigit(byte & 0xF, true);
+    }
+    return hex;
+  }
+
+  std::string path(const std::string &key, const std::string &ext) const {
+    return dir + "/" + key + "." + ext;
+  }
+
+  // Check for an entry, marking it as recently used.
+  bool lookup(const std::string &key, const std::string &ext) {
+    FileLock lock(lock_file(), false);
+    return utime(path(key, ext).c_str(), nullptr) == 0;
+  }
+
+  // Read an entry, returns nullptr if it doesn't exist (anymore).
+  std::unique_ptr<llvm::MemoryBuffer> read(const std::string &key,
+                                           const std::string &ext) {
+    FileLock lock(lock_file(), false);
+    auto buffer = llvm::MemoryBuffer::getFile(path(key, ext));
+    return buffer ? std::move(*buffer) : nullptr;
+  }
+
+  // Atomically write an entry.
+  void store(const std::string &key, const std::string &ext,
+             llvm::StringRef data) {
+    std::stringstream tmp_name;
+    tmp_name << path(key, ext) << ".tmp" << getpid() << "_"
+             << std::this_thread::get_id();
+    {
+      std::ofstream out(tmp_name.str(), std::ios::binary);
+      out.write(data.data(), data.size());
+      if (!out) {
+        std::remove(tmp_name.str().c_str());
+        return;
+      }
+    }
+    FileLock lock(lock_file(), false);
+    std::rename(tmp_name.str().c_str(), path(key, ext).c_str());
+  }
+
+  // Remove the least recently used entries until the cache fits in its
+  // size bound. Returns the number of removed files.
+  std::size_t evict() {
+    FileLock lock(lock_file(), true);
+    std::vector<std::tuple<time_t, std::uint64_t, std::string>> entries;
+    std::uint64_t total_size = 0;
+    if (DIR *d = opendir(dir.c_str())) {
+      while (auto entry = readdir(d)) {
+        const std::string name = entry->d_name;
+        struct stat st;
+        if (name[0] == '.' ||
+            stat((dir + "/" + name).c_str(), &st) != 0 ||
+            !S_ISREG(st.st_mode)) {
+          continue;
+        }
+        entries.emplace_back(st.st_mtime, st.st_size, dir + "/" + name);
+        total_size += st.st_size;
       }
+      closedir(d);
+    }
+    std::sort(entries.begin(), entries.end());
+    std::size_t nb_removed = 0;
+    for (const auto &[mtime, size, file] : entries) {
+      if (total_size <= max_size_bytes) {
+        break;
+      }
+      if (std::remove(file.c_str()) == 0) {
+        total_size -= size;
+        ++nb_removed;
+      }
+    }
+    return nb_removed;
+  }
+
+  // Modules that are not identified by a cache key (e.g. the partitions
+  // of the lazy mode) are not cached.
+  static bool is_key(const std::string &id) {
+    return id.size() == 40 &&
+           std::all_of(id.begin(), id.end(), [](char c) {
+             return std::isdigit(c) || (c >= 'a' && c <= 'f');
+           });
+  }
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override {
+    if (is_key(M->getModuleIdentifier())) {
+      store(M->getModuleIdentifier(), "o", Obj.getBuffer());
     }
   }
+
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override {
+    const auto key = M->getModuleIdentifier();
+    if (!is_key(key) || !lookup(key, "o")) {
+      return nullptr;
+    }
+    return read(key, "o");
+  }
+};
+
+// The native target is needed by the optimization pipeline (TargetMachine)
+// and the JIT, also when the kernel bitcode comes from the compile server.
+// Target registration is not thread-safe.
+void initialize_native_target() {
+  static std::once_flag init_target_flag;
+  std::call_once(init_target_flag, []() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  });
 }
-void QJIT::write_cache() {
-  std::string cache_file_loc = qjit_cache_path + "/qjit_cache.json";
-  nlohmann::json j;
-  j["jit_cache"] = cached_kernel_codes;
-  auto str = j.dump();
-  std::ofstream cache(cache_file_loc);
-  cache << str;
-  cache.close();
+
+// Host target of the JIT (detectHost): cached native objects are only valid
+// for the same triple, CPU and CPU features.
+const std::string &host_target_key() {
+  static const std::string key = []() {
+    std::string target = "triple " + sys::getProcessTriple() + "\n";
+    target += "cpu " + sys::getHostCPUName().str() + "\n";
+    StringMap<bool> host_features;
+    std::vector<std::string> features;
+    if (sys::getHostCPUFeatures(host_features)) {
+      for (const auto &feature : host_features) {
+        features.push_back((feature.second ? "+" : "-") +
+                           feature.first().str());
+      }
+    }
+    // StringMap iteration order is unspecified
+    std::sort(features.begin(), features.end());
+    target += "features " + llvm::join(features, ",") + "\n";
+    return target;
+  }();
+  return key;
+}
+
+// Installed XACC library, identified by its modification time and size:
+// upgrading XACC in place invalidates the kernels compiled against it.
+const std::string &xacc_build_key() {
+  static const std::string key = []() {
+    std::string xacc = "xacc @XACC_ROOT@";
+    struct stat st;
+    if (::stat("@XACC_ROOT@/lib/libxacc@CMAKE_SHARED_LIBRARY_SUFFIX@", &st) ==
+        0) {
+      xacc += " " + std::to_string((long long)st.st_mtime) + " " +
+              std::to_string((long long)st.st_size);
+    }
+    return xacc + "\n";
+  }();
+  return key;
 }
+
+// Give the internal global variables of a kernel Module external linkage,
+// under a name unique to the Module (its cache key). Specialized variants
+// of the kernel then use the storage of the kernel Module rather than private
+// copies, i.e. state written by one is seen by the other. Unnamed_addr
+// constants stay internal.
+void externalize_internal_globals(Module &M, const std::string &key) {
+  for (GlobalVariable &gv : M.globals()) {
+    if (gv.isDeclaration() || !gv.hasLocalLinkage() ||
+        gv.getName().startswith("llvm.") ||
+        (gv.isConstant() && gv.hasGlobalUnnamedAddr())) {
+      continue;
+    }
+    gv.setName(gv.getName() + ".qjit." + key);
+    gv.setLinkage(GlobalValue::ExternalLinkage);
+    gv.setVisibility(GlobalValue::DefaultVisibility);
+  }
+}
+
+// Run the standard LLVM optimization pipeline (opt_level 0-3)
+void optimize_module(Module &M, const int opt_level) {
+  if (opt_level <= 0) {
+    return;
+  }
+  // clang emits the kernels at -O0, i.e. with optnone (which requires
+  // noinline) on every function, which would disable the pipeline.
+  for (Function &f : M) {
+    if (f.hasFnAttribute(Attribute::OptimizeNone)) {
+      f.removeFnAttr(Attribute::OptimizeNone);
+      f.removeFnAttr(Attribute::NoInline);
+    }
+  }
+  std::unique_ptr<TargetMachine> TM;
+  if (auto JTMB = JITTargetMachineBuilder::detectHost()) {
+    if (auto created_tm = JTMB->createTargetMachine()) {
+      TM = std::move(*created_tm);
+    } else {
+      consumeError(created_tm.takeError());
+    }
+  } else {
+    consumeError(JTMB.takeError());
+  }
+
+  PassBuilder PB(TM.get());
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  const auto level = opt_level == 1   ? PassBuilder::OptimizationLevel::O1
+                     : opt_level == 2 ? PassBuilder::OptimizationLevel::O2
+                                      : PassBuilder::OptimizationLevel::O3;
+  ModulePassManager MPM = PB.buildPerModuleDefaultPipeline(level);
+  MPM.run(M, MAM);
+}
+
+QJIT::QJIT(const bool lazy, const int opt)
+    : lazy_compile(lazy), opt_level(opt) {
+  initialize_native_target();
+  // if tmp directory doesnt exist create it
+  qjit_cache_path = std::string(std::getenv("HOME")) + "/.qjit";
+  cache = std::make_unique<QJITCache>(qjit_cache_path);
+  if (opt_level < 0) {
+    const char *env_opt_level = std::getenv("QJIT_OPT_LEVEL");
+    opt_level = env_opt_level ? std::atoi(env_opt_level) : 0;
+  }
+  opt_level = std::min(opt_level, 3);
+}
+void QJIT::write_cache() { stats.evictions += cache->evict(); }
 QJIT::~QJIT() { write_cache(); }
 
-void QJIT::jit_compile(const std::string &code,
-                       const bool add_het_map_kernel_ctor,
-                       const std::vector<std::string> &kernel_dependency,
-                       const std::string &extra_functions_src,
-                       std::vector<std::string> extra_headers) {
+QJIT::KernelCode QJIT::prepare_kernel(
+    const std::string &code, const bool add_het_map_kernel_ctor,
+    const std::vector<std::string> &kernel_dependency,
+    const std::string &extra_functions_src,
+    const std::vector<std::string> &extra_headers) {
   // Run the Syntax Handler to get the kernel name and
   // the kernel code (the QuantumKernel subtype def + utility functions)
   auto [kernel_name, new_code] =
@@ -381,97 +666,267 @@ void QJIT::jit_compile(const std::string &code,
   new_code = extra_functions_src + "\n" + new_code;
 
   // std::cout << "New code:\n" << new_code << "\n";
-  // Hash the new code
-  std::hash<std::string> hasher;
-  auto hash = hasher(new_code);
-
-  // We will use cached Modules if possible...
+  // Cache key: the code and everything else affecting its compilation
+  std::string key_material = "qjit-cache-v3\n";
+  key_material += "llvm " LLVM_VERSION_STRING "\n";
+  key_material += host_target_key();
+  key_material += "qcor @CMAKE_INSTALL_PREFIX@ " __DATE__ " " __TIME__ "\n";
+  key_material += xacc_build_key();
+  key_material += add_het_map_kernel_ctor ? "hetmap\n" : "no-hetmap\n";
+  key_material += "opt " + std::to_string(opt_level) + "\n";
+  for (const auto &header : extra_headers) {
+    key_material += "header " + header + "\n";
+  }
+  key_material += new_code;
 
-  std::unique_ptr<CodeGenAction> act;
-  if (cached_kernel_codes.count(hash)) {
-    // If we have this hash in the cache, we will grab its
-    // correspoding Module bc file name and load it
-    auto module_bitcode_file_name = cached_kernel_codes[hash];
-    std::string full_path = qjit_cache_path + "/" + module_bitcode_file_name;
+  KernelCode kernel;
+  kernel.kernel_name = kernel_name;
+  kernel.code = new_code;
+  kernel.cache_key = QJITCache::hash(key_material);
+  return kernel;
+}
 
-    // Load the bitcode file as Module
+void QJIT::compile_kernel(KernelCode &kernel,
+                          const std::vector<std::string> &extra_headers) {
+  const auto start = std::chrono::steady_clock::now();
+  // Forward the compile to the local compile server (qcor-server)
+  // if it is running...
+  std::string server_bitcode;
+  if (compile_server::emit_llvm_bitcode(kernel.code, extra_headers,
+                                        server_bitcode)) {
+    kernel.ctx = std::make_unique<LLVMContext>();
     SMDiagnostic error;
-    auto ctx = std::make_unique<LLVMContext>();
-    module = llvm::parseIRFile(full_path, error, *ctx.get());
-    if (!jit) {
-      // Initialize the JIT Engine
-      llvm::InitializeNativeTarget();
-      llvm::InitializeNativeTargetAsmPrinter();
-      jit = cantFail(qcor::LLVMJIT::Create(std::move(ctx)));
+    kernel.module = llvm::parseIR(
+        MemoryBufferRef(server_bitcode, kernel.cache_key), error,
+        *kernel.ctx);
+  }
+  if (!kernel.module) {
+    // ... otherwise, map the code to an LLVM Module, taking
+    // ownership of its context
+    auto act = qcor::emit_llvm_ir(kernel.code, extra_headers);
+    kernel.module = act->takeModule();
+    kernel.ctx.reset(act->takeLLVMContext());
+  }
+
+  // Optimize it before it is cached and linked
+  if (opt_level > 0) {
+    const auto opt_start = std::chrono::steady_clock::now();
+    optimize_module(*kernel.module, opt_level);
+    kernel.optimize_time_ms += std::chrono::duration<double, std::milli>(
+                                   std::chrono::steady_clock::now() - opt_start)
+                                   .count();
+  }
+
+  externalize_internal_globals(*kernel.module, kernel.cache_key);
+
+  // Persist the Module to a bitcode file
+  llvm::SmallVector<char, 0> bitcode;
+  llvm::raw_svector_ostream bitcode_os(bitcode);
+  WriteBitcodeToFile(*kernel.module, bitcode_os);
+  cache->store(kernel.cache_key, "bc",
+               llvm::StringRef(bitcode.data(), bitcode.size()));
+  kernel.compile_time_ms += std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+}
+
+void QJIT::jit_compile(const std::string &code,
+                       const bool add_het_map_kernel_ctor,
+                       const std::vector<std::string> &kernel_dependency,
+                       const std::string &extra_functions_src,
+                       std::vector<std::string> extra_headers) {
+  auto kernel = prepare_kernel(code, add_het_map_kernel_ctor,
+                               kernel_dependency, extra_functions_src,
+                               extra_headers);
+  add_kernel(kernel, add_het_map_kernel_ctor, extra_headers);
+}
+
+void QJIT::jit_compile_many(const std::vector<std::string> &codes,
+                            const bool add_het_map_kernel_ctor,
+                            const std::string &extra_functions_src,
+                            std::vector<std::string> extra_headers,
+                            int nb_threads) {
+  // The syntax handler is not thread-safe, run it for all kernels first.
+  std::vector<KernelCode> kernels;
+  for (const auto &code : codes) {
+    kernels.emplace_back(prepare_kernel(code, add_het_map_kernel_ctor, {},
+                                        extra_functions_src, extra_headers));
+  }
+
+  // Compile the kernels that are not cached yet concurrently
+  std::vector<std::size_t> to_compile;
+  for (std::size_t i = 0; i < kernels.size(); i++) {
+    if (!cache->lookup(kernels[i].cache_key, "bc")) {
+      to_compile.emplace_back(i);
     }
+  }
+  if (nb_threads <= 0) {
+    nb_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  nb_threads = std::min<int>(nb_threads, to_compile.size());
+  std::atomic<std::size_t> next(0);
+  auto worker = [&]() {
+    for (std::size_t j = next++; j < to_compile.size(); j = next++) {
+      compile_kernel(kernels[to_compile[j]], extra_headers);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int t = 0; t < nb_threads; t++) {
+    workers.emplace_back(worker);
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
 
-  } else {
-    // We have not seen this code before, so we
-    // need to map it to an LLVM Module
-    act = qcor::emit_llvm_ir(new_code, extra_headers);
-    module = act->takeModule();
-
-    // Persist the Module to a bitcode file
-    std::stringstream file_name_ss;
-    file_name_ss << "__qjit_m_" << module.get() << ".bc";
-    std::error_code ec;
-    ToolOutputFile result(qjit_cache_path + "/" + file_name_ss.str(), ec,
-                          sys::fs::F_None);
-    WriteBitcodeToFile(*module, result.os());
-    result.keep();
-
-    // Add the file to the cache map, this gets persisted
-    // at QJIT Destruction
-    cached_kernel_codes.insert({hash, file_name_ss.str()});
-  }
-
-  // Loop over all Functions in the module
-  // and get the first one that has the kernel name
-  // in it as a substring. This is the corrent Function and
-  // now we have it as a mangled name
+  // Link them in order
+  for (std::size_t i = 0; i < kernels.size(); i++) {
+    add_kernel(kernels[i], add_het_map_kernel_ctor, extra_headers);
+  }
+}
+
+void QJIT::add_kernel(KernelCode &kernel, const bool add_het_map_kernel_ctor,
+                      const std::vector<std::string> &extra_headers) {
+  const auto &kernel_name = kernel.kernel_name;
+  const auto &cache_key = kernel.cache_key;
+  // Compile time of a kernel compiled ahead (jit_compile_many)
+  const double prior_compile_time_ms = kernel.compile_time_ms;
   std::string mangled_name = "", hetmap_mangled_name = "",
-              parent_hetmap_mangled_name = "";
-  for (Function &f : *module) {
-    auto name = f.getName().str();
-    if (demangle(name.c_str()).find(kernel_name) != std::string::npos) {
-      // First one we see is the correct kernel call
-      mangled_name = name;
-      break;
+              parent_hetmap_mangled_name = "", packed_mangled_name = "",
+              parent_packed_mangled_name = "";
+  const auto start = std::chrono::steady_clock::now();
+
+  // Create the JIT Engine if we haven't already
+  auto create_jit = [&](std::unique_ptr<LLVMContext> ctx) {
+    // Initialize the JIT Engine
+    jit = cantFail(qcor::LLVMJIT::Create(cache.get(), lazy_compile,
+                                         std::move(ctx)),
+                   "QJIT Error: Could not create the JIT Engine.");
+  };
+
+  // Fastest path: the native object and the kernel symbol names
+  // are cached, link the object directly (no parsing, no codegen).
+  bool object_hit = false;
+  if (!kernel.module && cache->lookup(cache_key, "meta") &&
+      cache->lookup(cache_key, "o")) {
+    auto meta = cache->read(cache_key, "meta");
+    auto object = cache->read(cache_key, "o");
+    if (meta && object) {
+      std::istringstream meta_ss(meta->getBuffer().str());
+      std::getline(meta_ss, mangled_name);
+      std::getline(meta_ss, hetmap_mangled_name);
+      std::getline(meta_ss, parent_hetmap_mangled_name);
+      std::getline(meta_ss, packed_mangled_name);
+      std::getline(meta_ss, parent_packed_mangled_name);
+      if (!mangled_name.empty()) {
+        if (!jit) {
+          create_jit(std::make_unique<LLVMContext>());
+        }
+        cantFail(jit->addObject(std::move(object)),
+                 "QJIT Error: Could not add the object to the JIT Engine.");
+        object_hit = true;
+      }
     }
   }
 
-  // Find the hetmap args function
-  for (Function &f : *module) {
-    auto name = f.getName().str();
-    if (demangle(name.c_str()).find(kernel_name + "__with_hetmap_args") !=
-        std::string::npos) {
-      // First one we see is the correct kernel call
-      hetmap_mangled_name = name;
-      break;
+  // Otherwise, we will use cached Modules if possible...
+  // In lazy mode, every Module gets its own context since
+  // it outlives this call (codegen on first invocation).
+  std::unique_ptr<LLVMContext> module_ctx;
+  bool module_hit = false;
+  module.reset();
+  if (!object_hit && !kernel.module && cache->lookup(cache_key, "bc")) {
+    // Load the bitcode file as Module
+    if (auto buffer = cache->read(cache_key, "bc")) {
+      SMDiagnostic error;
+      if (jit && !lazy_compile) {
+        // Parse in the JIT context, which outlives the Module
+        module = llvm::parseIR(buffer->getMemBufferRef(), error,
+                               jit->getContext());
+      } else {
+        module_ctx = std::make_unique<LLVMContext>();
+        module = llvm::parseIR(buffer->getMemBufferRef(), error, *module_ctx);
+        if (module && !jit) {
+          create_jit(lazy_compile ? std::make_unique<LLVMContext>()
+                                  : std::move(module_ctx));
+        }
+      }
+      module_hit = (module != nullptr);
     }
   }
 
-  // Find the parent composte + hetmap args function
-  for (Function &f : *module) {
-    auto name = f.getName().str();
-    if (demangle(name.c_str())
-            .find(kernel_name + "__with_parent_and_hetmap_args") !=
-        std::string::npos) {
-      // First one we see is the correct kernel call
-      parent_hetmap_mangled_name = name;
-      break;
+  if (!object_hit && !module_hit) {
+    // We have not seen this code before, so we
+    // need to map it to an LLVM Module
+    if (!kernel.module) {
+      compile_kernel(kernel, extra_headers);
     }
+    module = std::move(kernel.module);
+    module_ctx = std::move(kernel.ctx);
   }
 
-  // Create the JIT Engine if we haven't already
-  if (!jit) {
-    jit = cantFail(qcor::LLVMJIT::Create(),
-                   "QJIT Error: Could not create the JIT Engine.");
-  }
+  if (!object_hit) {
+    // Loop over all Functions in the module
+    // and get the first one that has the kernel name
+    // in it as a substring. This is the corrent Function and
+    // now we have it as a mangled name
+    for (Function &f : *module) {
+      auto name = f.getName().str();
+      if (demangle(name.c_str()).find(kernel_name) != std::string::npos) {
+        // First one we see is the correct kernel call
+        mangled_name = name;
+        break;
+      }
+    }
 
-  // Add the Module to the JIT Engine
-  cantFail(jit->addModule(std::move(module)),
-           "QJIT Error: Could not add the Module to the JIT Engine.");
+    // Find the hetmap args function
+    for (Function &f : *module) {
+      auto name = f.getName().str();
+      if (demangle(name.c_str()).find(kernel_name + "__with_hetmap_args") !=
+          std::string::npos) {
+        // First one we see is the correct kernel call
+        hetmap_mangled_name = name;
+        break;
+      }
+    }
+
+    // Find the parent composte + hetmap args function
+    for (Function &f : *module) {
+      auto name = f.getName().str();
+      if (demangle(name.c_str())
+              .find(kernel_name + "__with_parent_and_hetmap_args") !=
+          std::string::npos) {
+        // First one we see is the correct kernel call
+        parent_hetmap_mangled_name = name;
+        break;
+      }
+    }
+
+    // Find the packed args functions (typed fast path)
+    for (Function &f : *module) {
+      auto name = f.getName().str();
+      auto demangled = demangle(name.c_str());
+      if (packed_mangled_name.empty() &&
+          demangled.find(kernel_name + "__with_packed_args") !=
+              std::string::npos) {
+        packed_mangled_name = name;
+      }
+      if (parent_packed_mangled_name.empty() &&
+          demangled.find(kernel_name + "__with_parent_and_packed_args") !=
+              std::string::npos) {
+        parent_packed_mangled_name = name;
+      }
+    }
+
+    if (!jit) {
+      create_jit(std::make_unique<LLVMContext>());
+    }
+
+    // Add the Module to the JIT Engine, the compiled object
+    // is persisted by the cache under the Module identifier.
+    module->setModuleIdentifier(cache_key);
+    cantFail(jit->addModule(std::move(module), std::move(module_ctx)),
+             "QJIT Error: Could not add the Module to the JIT Engine.");
+  }
 
   // Get the function pointer and associate it with
   // the provided kernel name
@@ -492,11 +947,174 @@ void QJIT::jit_compile(const std::string &code,
     auto parent_hetmap_rawFPtr = parent_hetmap_symbol.getAddress();
     kernel_name_to_f_ptr_parent_hetmap.insert(
         {kernel_name, parent_hetmap_rawFPtr});
+
+    // Packed args entry points (absent from objects cached by
+    // older versions of the syntax handler)
+    if (!packed_mangled_name.empty() && !parent_packed_mangled_name.empty()) {
+      kernel_name_to_f_ptr_packed.insert(
+          {kernel_name,
+           cantFail(jit->lookup(packed_mangled_name)).getAddress()});
+      kernel_name_to_f_ptr_parent_packed.insert(
+          {kernel_name,
+           cantFail(jit->lookup(parent_packed_mangled_name)).getAddress()});
+    }
+  }
+
+  kernel_name_to_cache_key[kernel_name] = cache_key;
+  kernel_name_to_mangled_name[kernel_name] = mangled_name;
+
+  if (!object_hit && !lazy_compile) {
+    // The object has been compiled (and cached) by the lookups,
+    // cache the kernel symbol names alongside it.
+    cache->store(cache_key, "meta",
+                 mangled_name + "\n" + hetmap_mangled_name + "\n" +
+                     parent_hetmap_mangled_name + "\n" +
+                     packed_mangled_name + "\n" +
+                     parent_packed_mangled_name + "\n");
+  }
+
+  // Update the cache statistics (includes codegen and linking)
+  const double elapsed_ms = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+  if (object_hit || module_hit) {
+    stats.hits++;
+    if (object_hit) stats.object_hits++;
+    stats.load_time_ms += elapsed_ms;
+  } else {
+    stats.misses++;
+    stats.compile_time_ms += prior_compile_time_ms + elapsed_ms;
+    stats.optimize_time_ms += kernel.optimize_time_ms;
   }
 
   return;
 }
 
+std::string QJIT::specialize(const std::string &kernel_name,
+                             const std::map<int, double> &arg_values) {
+  const auto key_iter = kernel_name_to_cache_key.find(kernel_name);
+  if (key_iter == kernel_name_to_cache_key.end()) {
+    xacc::error("QJIT Error: cannot specialize " + kernel_name +
+                ", it has not been compiled.");
+  }
+
+  // Key of the variant
+  std::stringstream key_material;
+  key_material << "qjit-specialize-v2\n" << key_iter->second << "\n";
+  key_material << std::setprecision(17);
+  for (const auto &[index, value] : arg_values) {
+    key_material << index << "=" << value << "\n";
+  }
+  const auto spec_key = QJITCache::hash(key_material.str());
+  const std::string spec_name =
+      kernel_name + "__specialized_" + spec_key.substr(0, 12);
+  const std::string spec_symbol = "__qjit_specialized_" + spec_key;
+  if (kernel_name_to_f_ptr.count(spec_name)) {
+    return spec_name;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  auto register_variant = [&]() {
+    auto symbol = cantFail(jit->lookup(spec_symbol));
+    kernel_name_to_f_ptr.insert({spec_name, symbol.getAddress()});
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+
+  // Link the cached object of the variant if possible
+  if (cache->lookup(spec_key, "o")) {
+    if (auto object = cache->read(spec_key, "o")) {
+      cantFail(jit->addObject(std::move(object)),
+               "QJIT Error: Could not add the object to the JIT Engine.");
+      stats.hits++;
+      stats.object_hits++;
+      stats.load_time_ms += register_variant();
+      return spec_name;
+    }
+  }
+
+  // Otherwise, clone the kernel function from its Module
+  auto buffer = cache->read(key_iter->second, "bc");
+  if (!buffer) {
+    xacc::error("QJIT Error: the bitcode of " + kernel_name +
+                " is not in the cache anymore.");
+  }
+  SMDiagnostic error;
+  auto ctx = std::make_unique<LLVMContext>();
+  auto spec_module = llvm::parseIR(buffer->getMemBufferRef(), error, *ctx);
+  Function *kernel_function =
+      spec_module
+          ? spec_module->getFunction(kernel_name_to_mangled_name[kernel_name])
+          : nullptr;
+  if (!kernel_function) {
+    xacc::error("QJIT Error: could not load the kernel function of " +
+                kernel_name + ".");
+  }
+  // Argument indices are LLVM IR ones, an sret argument would shift them.
+  if (kernel_function->hasStructRetAttr()) {
+    xacc::error("QJIT Error: cannot specialize " + kernel_name +
+                ", it returns an aggregate (sret argument).");
+  }
+
+  // Map the specialized arguments to constants, CloneFunction
+  // drops them from the signature of the clone.
+  ValueToValueMapTy vmap;
+  for (const auto &[index, value] : arg_values) {
+    if (index < 0 || index >= (int)kernel_function->arg_size()) {
+      xacc::error("QJIT Error: invalid argument index " +
+                  std::to_string(index) + " for " + kernel_name + ".");
+    }
+    Argument *arg = kernel_function->arg_begin() + index;
+    Type *arg_type = arg->getType();
+    if (arg_type->isIntegerTy()) {
+      vmap[arg] = ConstantInt::get(arg_type, (std::int64_t)value, true);
+    } else if (arg_type->isFloatingPointTy()) {
+      vmap[arg] = ConstantFP::get(arg_type, value);
+    } else {
+      xacc::error("QJIT Error: argument " + std::to_string(index) + " of " +
+                  kernel_name + " cannot be specialized (not an integer or "
+                  "floating point value).");
+    }
+  }
+  Function *spec_function = CloneFunction(kernel_function, vmap);
+  spec_function->setName(spec_symbol);
+  spec_function->setLinkage(GlobalValue::ExternalLinkage);
+  spec_function->setComdat(nullptr);
+
+  // Only the variant is exported: the other functions are internalized
+  // (so that they can be inlined and folded), the global variables
+  // (externalized when the kernel was compiled) are declarations of those of
+  // the kernel Module already in the JIT. Note that the JIT doesn't run
+  // llvm.global_ctors, neither for the kernel Module nor for the variant.
+  for (Function &f : *spec_module) {
+    if (&f != spec_function && !f.isDeclaration()) {
+      f.setLinkage(GlobalValue::InternalLinkage);
+      f.setComdat(nullptr);
+    }
+  }
+  if (auto ctors = spec_module->getGlobalVariable("llvm.global_ctors")) {
+    ctors->eraseFromParent();
+  }
+  for (GlobalVariable &gv : spec_module->globals()) {
+    if (!gv.isDeclaration() && !gv.hasLocalLinkage() &&
+        !gv.getName().startswith("llvm.")) {
+      gv.setInitializer(nullptr);
+      gv.setLinkage(GlobalValue::ExternalLinkage);
+      gv.setComdat(nullptr);
+    }
+  }
+
+  optimize_module(*spec_module, std::max(2, opt_level));
+
+  spec_module->setModuleIdentifier(spec_key);
+  cantFail(jit->addModule(std::move(spec_module), std::move(ctx)),
+           "QJIT Error: Could not add the Module to the JIT Engine.");
+  stats.misses++;
+  stats.compile_time_ms += register_variant();
+  return spec_name;
+}
+
 void QJIT::invoke_with_hetmap(const std::string &kernel_name,
                               xacc::HeterogeneousMap &args) {
   auto f_ptr = kernel_name_to_f_ptr_hetmap[kernel_name];
@@ -517,4 +1135,32 @@ std::shared_ptr<xacc::CompositeInstruction> QJIT::extract_composite_with_hetmap(
   kernel_functor(composite, args);
   return composite;
 }
+
+bool QJIT::invoke_with_packed_args(const std::string &kernel_name,
+                                   void **args) {
+  auto iter = kernel_name_to_f_ptr_packed.find(kernel_name);
+  if (iter == kernel_name_to_f_ptr_packed.end()) {
+    return false;
+  }
+  void (*kernel_functor)(void **) = (void (*)(void **))iter->second;
+  kernel_functor(args);
+  return true;
+}
+
+std::shared_ptr<xacc::CompositeInstruction>
+QJIT::extract_composite_with_packed_args(const std::string kernel_name,
+                                         void **args) {
+  auto iter = kernel_name_to_f_ptr_parent_packed.find(kernel_name);
+  if (iter == kernel_name_to_f_ptr_parent_packed.end()) {
+    return nullptr;
+  }
+  auto composite =
+      xacc::getIRProvider("quantum")->createComposite(kernel_name + "_qjit");
+  void (*kernel_functor)(std::shared_ptr<xacc::CompositeInstruction>,
+                         void **) =
+      (void (*)(std::shared_ptr<xacc::CompositeInstruction>, void **))
+          iter->second;
+  kernel_functor(composite, args);
+  return composite;
+}
 }  // namespace qcor
@@ -2,6 +2,7 @@
 
 #include <functional>
 
+#include "optimization_history.hpp"
 #include "qcor_observable.hpp"
 #include "qcor_utils.hpp"
 #include "quantum_kernel.hpp"
@@ -25,6 +26,36 @@ class ObjectiveFunction : public xacc::OptFunction, public xacc::Identifiable {
   HeterogeneousMap options;
   std::vector<double> current_iterate_parameters;
 
+  // Optional bounded-memory record of all evaluations, enabled
+  // by the history-size and / or history-file options
+  std::shared_ptr<OptimizationHistory> history;
+
+  void configure_history() {
+    if (!options.keyExists<int>("history-size") &&
+        !options.stringExists("history-file")) {
+      history.reset();
+      return;
+    }
+    std::size_t capacity = OptimizationHistory::DEFAULT_CAPACITY;
+    if (options.keyExists<int>("history-size")) {
+      const int history_size = options.get<int>("history-size");
+      if (history_size < 1) {
+        error("Invalid history-size (" + std::to_string(history_size) +
+              "), must be at least 1.");
+      }
+      capacity = history_size;
+    }
+    const std::string filename = options.stringExists("history-file")
+                                     ? options.getString("history-file")
+                                     : "";
+    // Keep recording into the same history if nothing changed
+    if (history && history->capacity() == capacity &&
+        history->filename() == filename) {
+      return;
+    }
+    history = std::make_shared<OptimizationHistory>(capacity, filename);
+  }
+
  public:
   double operator()(const std::vector<double> &x) {
     std::vector<double> unused_grad;
@@ -50,12 +81,20 @@ class ObjectiveFunction : public xacc::OptFunction, public xacc::Identifiable {
     current_iterate_parameters = x;
   }
   // Set any extra options needed for the objective function
-  virtual void set_options(HeterogeneousMap &opts) { options = opts; }
+  virtual void set_options(HeterogeneousMap &opts) {
+    options = opts;
+    configure_history();
+  }
   template <typename T>
   void update_options(const std::string key, T value) {
     options.insert(key, value);
   }
 
+  // Return the evaluation history, nullptr if not enabled
+  virtual std::shared_ptr<OptimizationHistory> get_history() {
+    return history;
+  }
+
   // this really shouldnt be called.
   virtual xacc::internal_compiler::qreg get_qreg() {
     throw std::bad_function_call();
@@ -67,11 +106,6 @@ namespace __internal__ {
 // Get the objective function from the service registry
 std::shared_ptr<ObjectiveFunction> get_objective(const std::string &type);
 
-template <typename T>
-std::shared_ptr<T> qcor_as_shared(T *t) {
-  return std::shared_ptr<T>(t, [](T *const) {});
-}
-
 template <std::size_t... Is>
 auto create_tuple_impl(std::index_sequence<Is...>,
                        const std::vector<double> &arguments) {
@@ -230,6 +264,11 @@ class ObjectiveFunctionImpl : public ObjectiveFunction {
   // Return the qreg
   xacc::internal_compiler::qreg get_qreg() override { return qreg; }
 
+  // History is recorded by the helper
+  std::shared_ptr<OptimizationHistory> get_history() override {
+    return helper->get_history();
+  }
+
   // Provide a name and description
   const std::string name() const override { return "objective-impl"; }
   const std::string description() const override { return ""; }
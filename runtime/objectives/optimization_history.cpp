@@ -0,0 +1,67 @@
+#include "optimization_history.hpp"
+
+#include "xacc.hpp"
+#include <iomanip>
+
+namespace qcor {
+OptimizationHistory::OptimizationHistory(const std::size_t capacity,
+                                         const std::string &filename)
+    : m_capacity(std::max<std::size_t>(capacity, 1)), m_filename(filename) {
+  m_buffer.reserve(m_capacity);
+  if (!m_filename.empty()) {
+    m_file.open(m_filename, std::ios::out | std::ios::app);
+    if (!m_file.is_open()) {
+      xacc::error("OptimizationHistory: could not open " + m_filename);
+    }
+    m_file << std::setprecision(16);
+  }
+}
+
+void OptimizationHistory::record(const HistoryEntry &entry) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_buffer.size() < m_capacity) {
+    m_buffer.push_back(entry);
+  } else {
+    m_buffer[m_head] = entry;
+  }
+  m_head = (m_head + 1) % m_capacity;
+  m_total++;
+
+  if (m_file.is_open()) {
+    m_file << entry.iteration << "," << entry.energy << "," << entry.stddev
+           << "," << entry.elapsed_ms;
+    for (const auto &p : entry.parameters) {
+      m_file << "," << p;
+    }
+    m_file << std::endl;
+  }
+}
+
+std::vector<HistoryEntry> OptimizationHistory::entries() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_buffer.size() < m_capacity) {
+    return m_buffer;
+  }
+  std::vector<HistoryEntry> ordered(m_buffer.begin() + m_head, m_buffer.end());
+  ordered.insert(ordered.end(), m_buffer.begin(), m_buffer.begin() + m_head);
+  return ordered;
+}
+
+HistoryEntry OptimizationHistory::last() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_buffer.empty()) {
+    xacc::error("OptimizationHistory: no entries recorded.");
+  }
+  return m_buffer[(m_head + m_capacity - 1) % m_capacity];
+}
+
+std::size_t OptimizationHistory::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_buffer.size();
+}
+
+std::size_t OptimizationHistory::total_recorded() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_total;
+}
+} // namespace qcor
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qcor {
+
+// One ObjectiveFunction evaluation
+struct HistoryEntry {
+  int iteration;
+  std::vector<double> parameters;
+  double energy;
+  double stddev;
+  // Wall-clock time of the evaluation (milliseconds)
+  double elapsed_ms;
+};
+
+// The OptimizationHistory records ObjectiveFunction evaluations
+// in a fixed-size in-memory ring buffer, and optionally streams every
+// entry to an append-only CSV file, one line per evaluation:
+//   iteration,energy,stddev,elapsed-ms,param_0,param_1,...
+// Lines are flushed as they are written so the file survives crashes.
+// Memory use is constant regardless of the number of iterations.
+class OptimizationHistory {
+public:
+  static constexpr std::size_t DEFAULT_CAPACITY = 100;
+
+  OptimizationHistory(const std::size_t capacity = DEFAULT_CAPACITY,
+                      const std::string &filename = "");
+
+  // Record a new evaluation
+  void record(const HistoryEntry &entry);
+
+  // Return the entries currently held in memory, oldest first
+  std::vector<HistoryEntry> entries() const;
+  // Return the most recent entry (must not be empty)
+  HistoryEntry last() const;
+
+  std::size_t size() const;
+  std::size_t capacity() const { return m_capacity; }
+  // Total number of evaluations ever recorded
+  std::size_t total_recorded() const;
+  const std::string &filename() const { return m_filename; }
+
+private:
+  std::size_t m_capacity;
+  std::string m_filename;
+  std::vector<HistoryEntry> m_buffer;
+  // Next write position in the ring buffer
+  std::size_t m_head = 0;
+  std::size_t m_total = 0;
+  std::ofstream m_file;
+  mutable std::mutex m_mutex;
+};
+} // namespace qcor
@@ -5,7 +5,9 @@
 #include "cppmicroservices/ServiceProperties.h"
 using namespace cppmicroservices;
 
+#include <chrono>
 #include <memory>
+#include <map>
 #include <set>
 #include <iomanip> 
 
@@ -28,6 +30,20 @@ std::ostream &operator<<(std::ostream &os, const std::vector<T> &v) {
   os << "]";
   return os;
 }
+
+// Streaming mean / variance accumulation (Welford's algorithm)
+struct RunningStatistics {
+  std::size_t count = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+  void add(const double x) {
+    count++;
+    const double delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+  }
+  double stddev() const { return count > 0 ? std::sqrt(m2 / count) : 0.0; }
+};
 } // namespace
 namespace qcor {
 
@@ -36,6 +52,7 @@ public:
   std::shared_ptr<xacc::Algorithm> vqe;
   double operator()(xacc::internal_compiler::qreg &qreg,
                     std::vector<double> &dx) override {
+    const auto start_time = std::chrono::high_resolution_clock::now();
     if (!vqe) {
       vqe = xacc::getAlgorithm("vqe");
     }
@@ -49,23 +66,29 @@ public:
     }
 
     auto tmp_child = qalloc(qreg.size());
-    auto val = vqe->execute(xacc::as_shared_ptr(tmp_child.results()), {})[0];
+    double val = 0.0;
+    // If we need gradients, submit the energy and gradient
+    // circuits together as a single batch
+    const bool batch_gradient =
+        !dx.empty() && options.stringExists("gradient-strategy") &&
+        !(options.keyExists<bool>("gradient-batch-execution") &&
+          !options.get<bool>("gradient-batch-execution"));
+    std::shared_ptr<xacc::AlgorithmGradientStrategy> batch_gradient_strategy;
+    std::vector<std::shared_ptr<xacc::AcceleratorBuffer>> batch_grad_children;
+    if (batch_gradient) {
+      val = execute_energy_and_gradient(qpu, tmp_child, batch_gradient_strategy,
+                                        batch_grad_children);
+    } else {
+      val = vqe->execute(xacc::as_shared_ptr(tmp_child.results()), {})[0];
+    }
     double std_dev = 0.0;
     if (options.keyExists<int>("vqe-gather-statistics")) {
-      std::vector<double> all_energies;
-      all_energies.push_back(val);
+      RunningStatistics stats;
+      stats.add(val);
       auto n = options.get<int>("vqe-gather-statistics");
-      for (int i = 1; i < n; i++) {
-        auto tmp_child = qalloc(qreg.size());
-        auto local_val =
-            vqe->execute(xacc::as_shared_ptr(tmp_child.results()), {})[0];
-        all_energies.push_back(local_val);
-      }
-      auto sum = std::accumulate(all_energies.begin(), all_energies.end(), 0.);
-      val = sum / all_energies.size();
-      double sq_sum = std::inner_product(
-          all_energies.begin(), all_energies.end(), all_energies.begin(), 0.0);
-      std_dev = std::sqrt(sq_sum / all_energies.size() - val * val);
+      gather_energy_statistics(qpu, qreg.size(), n - 1, stats);
+      val = stats.mean;
+      std_dev = stats.stddev();
     }
 
     std::cout << "<H>(" << this->current_iterate_parameters << ") = " << std::setprecision(12) << val;
@@ -75,43 +98,226 @@ public:
       std::cout << std::endl;
     }
     
-    // want to store parameters, have to do it here
-    for (auto &child : tmp_child.results()->getChildren()) {
-      child->addExtraInfo("parameters", current_iterate_parameters);
-      auto tmp = current_iterate_parameters;
-      tmp.push_back(val);
-      child->addExtraInfo("qcor-params-energy", tmp);
-      if (std::fabs(std_dev) > 1e-12) {
-        child->addExtraInfo("qcor-energy-stddev", std_dev);
+    // If a history recorder is enabled, we don't keep every
+    // child buffer in the qreg unless explicitly requested.
+    const bool keep_children =
+        !history || (options.keyExists<bool>("history-keep-children") &&
+                     options.get<bool>("history-keep-children"));
+    if (keep_children) {
+      // want to store parameters, have to do it here
+      for (auto &child : tmp_child.results()->getChildren()) {
+        child->addExtraInfo("parameters", current_iterate_parameters);
+        auto tmp = current_iterate_parameters;
+        tmp.push_back(val);
+        child->addExtraInfo("qcor-params-energy", tmp);
+        if (std::fabs(std_dev) > 1e-12) {
+          child->addExtraInfo("qcor-energy-stddev", std_dev);
+        }
+        child->addExtraInfo("iteration", current_iteration);
       }
-      child->addExtraInfo("iteration", current_iteration);
+      qreg.addChild(tmp_child);
     }
-    current_iteration++;
-    qreg.addChild(tmp_child);
+    const int iteration = current_iteration++;
 
-    if (!dx.empty() && options.stringExists("gradient-strategy")) {
+    if (batch_gradient) {
+      // Gradient results were executed with the energy. The strategy was
+      // initialized before getGradientExecutions, which may store state
+      // used by compute: only set the final (possibly averaged) energy.
+      set_gradient_function_value(batch_gradient_strategy, val);
+      batch_gradient_strategy->compute(dx, batch_grad_children);
+    } else if (!dx.empty() &&
+        options.stringExists("gradient-strategy")) {
       // Compute the gradient
-      auto gradient_strategy =
-          xacc::getService<xacc::AlgorithmGradientStrategy>(
-              options.getString("gradient-strategy"));
-
-      if (gradient_strategy->isNumerical()) {
-        gradient_strategy->setFunctionValue(
-            val - std::real(observable->getIdentitySubTerm()->coefficient()));
-      }
-
-      gradient_strategy->initialize(options);
+      auto gradient_strategy = get_gradient_strategy(val);
       auto grad_kernels = gradient_strategy->getGradientExecutions(
           kernel, current_iterate_parameters);
 
-      auto tmp_grad = qalloc(qreg.size());
-      qpu->execute(xacc::as_shared_ptr(tmp_grad.results()), grad_kernels);
-      auto tmp_grad_children = tmp_grad.results()->getChildren();
-      gradient_strategy->compute(dx, tmp_grad_children);
+      if (!grad_kernels.empty()) {
+        auto tmp_grad = qalloc(qreg.size());
+        qpu->execute(xacc::as_shared_ptr(tmp_grad.results()), grad_kernels);
+        auto tmp_grad_children = tmp_grad.results()->getChildren();
+        gradient_strategy->compute(dx, tmp_grad_children);
+      } else {
+        // Analytic strategies (e.g. adjoint) need no executions
+        gradient_strategy->compute(dx, {});
+      }
+    }
+
+    if (history) {
+      const std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::high_resolution_clock::now() - start_time;
+      history->record({iteration, current_iterate_parameters, val, std_dev,
+                       elapsed.count()});
     }
     return val;
   }
 
+protected:
+  std::shared_ptr<xacc::AlgorithmGradientStrategy>
+  get_gradient_strategy(const double energy) {
+    auto gradient_strategy = xacc::getService<xacc::AlgorithmGradientStrategy>(
+        options.getString("gradient-strategy"));
+    set_gradient_function_value(gradient_strategy, energy);
+    gradient_strategy->initialize(options);
+    return gradient_strategy;
+  }
+
+  void set_gradient_function_value(
+      std::shared_ptr<xacc::AlgorithmGradientStrategy> gradient_strategy,
+      const double energy) {
+    if (gradient_strategy->isNumerical()) {
+      gradient_strategy->setFunctionValue(
+          energy - std::real(observable->getIdentitySubTerm()->coefficient()));
+    }
+  }
+
+  // Split the observed kernels into identity and measured terms,
+  // same logic as the xacc vqe algorithm
+  std::vector<std::shared_ptr<CompositeInstruction>>
+  observe_kernel(double &identity_coeff, std::vector<double> &coefficients) {
+    std::vector<std::shared_ptr<CompositeInstruction>> energy_kernels;
+    for (auto &f : observable->observe(kernel)) {
+      const auto coeff = std::real(f->getCoefficient());
+      int n_instructions = f->nInstructions();
+      if (n_instructions > 0 && f->getInstruction(0)->isComposite()) {
+        n_instructions = kernel->nInstructions() + f->nInstructions() - 1;
+      }
+      if (n_instructions > kernel->nInstructions()) {
+        energy_kernels.push_back(f);
+        coefficients.push_back(coeff);
+      } else {
+        identity_coeff += coeff;
+      }
+    }
+    return energy_kernels;
+  }
+
+  // Evaluate the energy n_samples more times and accumulate into stats.
+  // All repetitions are submitted together (in chunks of
+  // vqe-gather-statistics-batch-size if set) so the backend can sample
+  // them independently in one execution.
+  void gather_energy_statistics(std::shared_ptr<xacc::Accelerator> qpu,
+                                const int n_qubits, const int n_samples,
+                                RunningStatistics &stats) {
+    double identity_coeff = 0.0;
+    std::vector<double> coefficients;
+    auto energy_kernels = observe_kernel(identity_coeff, coefficients);
+    if (energy_kernels.empty()) {
+      for (int i = 0; i < n_samples; i++) {
+        stats.add(identity_coeff);
+      }
+      return;
+    }
+
+    int batch_size = n_samples;
+    if (options.keyExists<int>("vqe-gather-statistics-batch-size")) {
+      batch_size = std::max(
+          1, options.get<int>("vqe-gather-statistics-batch-size"));
+    }
+
+    const int n_terms = energy_kernels.size();
+    for (int start = 0; start < n_samples; start += batch_size) {
+      const int n_batch = std::min(batch_size, n_samples - start);
+      std::vector<std::shared_ptr<CompositeInstruction>> batch;
+      batch.reserve(n_batch * n_terms);
+      for (int r = 0; r < n_batch; r++) {
+        batch.insert(batch.end(), energy_kernels.begin(), energy_kernels.end());
+      }
+
+      auto tmp_batch = qalloc(n_qubits);
+      qpu->execute(xacc::as_shared_ptr(tmp_batch.results()), batch);
+      auto batch_children = tmp_batch.results()->getChildren();
+      if (batch_children.size() != batch.size()) {
+        xacc::error("QCOR VQE Error - batched execution returned " +
+                    std::to_string(batch_children.size()) +
+                    " results, expected " + std::to_string(batch.size()));
+      }
+
+      for (int r = 0; r < n_batch; r++) {
+        double energy = identity_coeff;
+        for (int i = 0; i < n_terms; i++) {
+          energy += coefficients[i] *
+                    batch_children[r * n_terms + i]->getExpectationValueZ();
+        }
+        stats.add(energy);
+      }
+    }
+  }
+
+  // Execute the observed energy circuits and all gradient circuits
+  // in a single submission to the qpu. Energy children are appended
+  // to the provided child buffer, the gradient strategy and its
+  // results are returned for the caller to compute the gradient.
+  double execute_energy_and_gradient(
+      std::shared_ptr<xacc::Accelerator> qpu,
+      xacc::internal_compiler::qreg &child,
+      std::shared_ptr<xacc::AlgorithmGradientStrategy> &gradient_strategy,
+      std::vector<std::shared_ptr<xacc::AcceleratorBuffer>> &grad_children) {
+    double identity_coeff = 0.0;
+    std::vector<double> coefficients;
+    auto energy_kernels = observe_kernel(identity_coeff, coefficients);
+
+    // Gradient executions only depend on the kernel and parameters,
+    // the function value (numerical strategies) is set by the caller
+    // before compute().
+    gradient_strategy = xacc::getService<xacc::AlgorithmGradientStrategy>(
+        options.getString("gradient-strategy"));
+    gradient_strategy->initialize(options);
+    auto grad_kernels = gradient_strategy->getGradientExecutions(
+        kernel, current_iterate_parameters);
+
+    // Assemble the batch, optionally removing circuits that coincide
+    // (e.g. shifted circuits that reduce to the same gate sequence)
+    const bool dedup =
+        options.keyExists<bool>("gradient-deduplicate-circuits") &&
+        options.get<bool>("gradient-deduplicate-circuits");
+    std::vector<std::shared_ptr<CompositeInstruction>> batch;
+    std::vector<std::size_t> batch_index;
+    std::map<std::string, std::size_t> seen;
+    auto add_to_batch = [&](std::shared_ptr<CompositeInstruction> f) {
+      if (dedup) {
+        auto key = f->toString();
+        auto iter = seen.find(key);
+        if (iter != seen.end()) {
+          batch_index.push_back(iter->second);
+          return;
+        }
+        seen.insert({key, batch.size()});
+      }
+      batch_index.push_back(batch.size());
+      batch.push_back(f);
+    };
+    for (auto &f : energy_kernels) {
+      add_to_batch(f);
+    }
+    for (auto &f : grad_kernels) {
+      add_to_batch(f);
+    }
+
+    auto tmp_batch = qalloc(child.size());
+    qpu->execute(xacc::as_shared_ptr(tmp_batch.results()), batch);
+    auto batch_children = tmp_batch.results()->getChildren();
+    if (batch_children.size() != batch.size()) {
+      xacc::error("QCOR VQE Error - batched execution returned " +
+                  std::to_string(batch_children.size()) +
+                  " results, expected " + std::to_string(batch.size()));
+    }
+
+    // Split back into energy and gradient results
+    double energy = identity_coeff;
+    for (std::size_t i = 0; i < energy_kernels.size(); i++) {
+      auto &result = batch_children[batch_index[i]];
+      energy += coefficients[i] * result->getExpectationValueZ();
+      child.results()->appendChild(energy_kernels[i]->name(), result);
+    }
+
+    grad_children.clear();
+    for (std::size_t i = energy_kernels.size(); i < batch_index.size(); i++) {
+      grad_children.push_back(batch_children[batch_index[i]]);
+    }
+    return energy;
+  }
+
 public:
   int current_iteration = 0;
   const std::string name() const override { return "vqe"; }
@@ -1,10 +1,20 @@
 #include "qcor_observable.hpp"
 
 #include "ObservableTransform.hpp"
+#include "Utils.hpp"
 #include "xacc.hpp"
 #include "xacc_quantum_gate_api.hpp"
 #include "xacc_service.hpp"
 
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
 namespace qcor {
 
 PauliOperator operator+(double coeff, PauliOperator &op) {
@@ -110,14 +120,187 @@ std::shared_ptr<Observable> createOperator(const std::string &name,
   return createObservable(name, options);
 }
 
+namespace {
+// Transform cache: in-memory map keyed by the transform name and the input
+// operator, and on-disk files (one per transformed operator) named after a
+// hash of the same. A disk entry stores its input, verified on read.
+std::mutex transform_cache_mutex;
+std::unordered_map<std::string, std::shared_ptr<PauliOperator>>
+    transform_cache;
+
+const char TRANSFORM_CACHE_MAGIC[8] = {'Q', 'C', 'O', 'R', 'P', 'A', 'U', '2'};
+
+// FNV-1a 64-bit hash
+uint64_t fnv1a(const std::string &str, uint64_t hash = 14695981039346656037ULL) {
+  for (const auto c : str) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string transform_cache_input(const std::string &type,
+                                  const std::string &op_str) {
+  return type + "\n" + op_str;
+}
+
+// Disk cache file name (without directory) of a transform input
+std::string transform_cache_file(const std::string &type,
+                                 const std::string &input) {
+  std::stringstream ss;
+  ss << type << "-" << std::hex << fnv1a(input) << "-" << input.size()
+     << ".bin";
+  return ss.str();
+}
+
+// $QCOR_TRANSFORM_CACHE_DIR or $HOME/.qcor_transform_cache,
+// empty if disk caching is disabled (QCOR_TRANSFORM_CACHE_DIR="")
+std::string transform_cache_dir() {
+  std::string dir;
+  if (const char *env_dir = std::getenv("QCOR_TRANSFORM_CACHE_DIR")) {
+    dir = env_dir;
+  } else if (const char *home = std::getenv("HOME")) {
+    dir = std::string(home) + "/.qcor_transform_cache";
+  }
+  if (!dir.empty() && !xacc::directoryExists(dir)) {
+    mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  }
+  return dir;
+}
+
+// Binary format: magic, size and bytes of the transform input, number of
+// terms, then for each term the complex coefficient, the number of ops and
+// the (qubit, X|Y|Z) ops.
+void write_pauli(const std::string &file_name, const std::string &input,
+                 PauliOperator &op) {
+  const std::string tmp_file_name =
+      file_name + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return;
+    }
+    out.write(TRANSFORM_CACHE_MAGIC, sizeof(TRANSFORM_CACHE_MAGIC));
+    const uint64_t input_size = input.size();
+    out.write(reinterpret_cast<const char *>(&input_size), sizeof(input_size));
+    out.write(input.data(), input.size());
+    const uint64_t n_terms = op.getTerms().size();
+    out.write(reinterpret_cast<const char *>(&n_terms), sizeof(n_terms));
+    for (auto &[term_str, term] : op.getTerms()) {
+      const double coeff[2] = {std::real(term.coeff()),
+                               std::imag(term.coeff())};
+      out.write(reinterpret_cast<const char *>(coeff), sizeof(coeff));
+      const uint32_t n_ops = term.ops().size();
+      out.write(reinterpret_cast<const char *>(&n_ops), sizeof(n_ops));
+      for (auto &[qubit, pauli] : term.ops()) {
+        const uint32_t idx = qubit;
+        out.write(reinterpret_cast<const char *>(&idx), sizeof(idx));
+        out.put(pauli[0]);
+      }
+    }
+  }
+  // Atomic replace: concurrent readers never see a partial file.
+  std::rename(tmp_file_name.c_str(), file_name.c_str());
+}
+
+// Null if the file is missing, invalid or was written for another input
+// (hash collision).
+std::shared_ptr<PauliOperator> read_pauli(const std::string &file_name,
+                                          const std::string &input) {
+  std::ifstream in(file_name, std::ios::binary);
+  if (!in) {
+    return nullptr;
+  }
+  char magic[sizeof(TRANSFORM_CACHE_MAGIC)];
+  uint64_t input_size = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&input_size), sizeof(input_size));
+  if (!in || !std::equal(magic, magic + sizeof(magic), TRANSFORM_CACHE_MAGIC) ||
+      input_size != input.size()) {
+    return nullptr;
+  }
+  std::string stored_input(input_size, '\0');
+  uint64_t n_terms = 0;
+  in.read(&stored_input[0], input_size);
+  in.read(reinterpret_cast<char *>(&n_terms), sizeof(n_terms));
+  if (!in || stored_input != input) {
+    return nullptr;
+  }
+  auto result = std::make_shared<PauliOperator>();
+  for (uint64_t i = 0; i < n_terms; i++) {
+    double coeff[2];
+    uint32_t n_ops = 0;
+    in.read(reinterpret_cast<char *>(coeff), sizeof(coeff));
+    in.read(reinterpret_cast<char *>(&n_ops), sizeof(n_ops));
+    std::map<int, std::string> ops;
+    for (uint32_t j = 0; j < n_ops; j++) {
+      uint32_t idx = 0;
+      in.read(reinterpret_cast<char *>(&idx), sizeof(idx));
+      ops[idx] = std::string(1, (char)in.get());
+    }
+    if (!in) {
+      return nullptr;
+    }
+    const std::complex<double> c(coeff[0], coeff[1]);
+    *result += ops.empty() ? PauliOperator(c) : PauliOperator(ops, c);
+  }
+  return result;
+}
+} // namespace
+
 std::shared_ptr<Observable> operatorTransform(const std::string &type,
                                               qcor::Observable &op) {
-  return xacc::getService<xacc::ObservableTransform>(type)->transform(
-      xacc::as_shared_ptr(&op));
+  return operatorTransform(type, xacc::as_shared_ptr(&op));
 }
 std::shared_ptr<Observable> operatorTransform(const std::string &type,
                                               std::shared_ptr<Observable> op) {
-  return xacc::getService<xacc::ObservableTransform>(type)->transform(op);
+  const auto key = transform_cache_input(type, op->toString());
+  {
+    std::lock_guard<std::mutex> lock(transform_cache_mutex);
+    auto iter = transform_cache.find(key);
+    if (iter != transform_cache.end()) {
+      // Return a copy: callers may modify the transformed operator.
+      return std::make_shared<PauliOperator>(*iter->second);
+    }
+  }
+
+  const auto cache_dir = transform_cache_dir();
+  const auto cache_file = cache_dir + "/" + transform_cache_file(type, key);
+  auto result = cache_dir.empty() ? nullptr : read_pauli(cache_file, key);
+  if (!result) {
+    auto transformed =
+        xacc::getService<xacc::ObservableTransform>(type)->transform(op);
+    result = std::dynamic_pointer_cast<PauliOperator>(transformed);
+    // Only qubit (Pauli) operators are cached.
+    if (!result) {
+      return transformed;
+    }
+    if (!cache_dir.empty()) {
+      write_pauli(cache_file, key, *result);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(transform_cache_mutex);
+  transform_cache[key] = result;
+  return std::make_shared<PauliOperator>(*result);
+}
+
+void clearTransformCache(bool clear_disk) {
+  std::lock_guard<std::mutex> lock(transform_cache_mutex);
+  transform_cache.clear();
+  const auto cache_dir = transform_cache_dir();
+  if (clear_disk && !cache_dir.empty()) {
+    if (DIR *dir = opendir(cache_dir.c_str())) {
+      while (auto entry = readdir(dir)) {
+        const std::string file_name = entry->d_name;
+        if (file_name.size() > 4 &&
+            file_name.compare(file_name.size() - 4, 4, ".bin") == 0) {
+          std::remove((cache_dir + "/" + file_name).c_str());
+        }
+      }
+      closedir(dir);
+    }
+  }
 }
 
 namespace __internal__ {
@@ -126,6 +309,86 @@ std::vector<std::shared_ptr<xacc::CompositeInstruction>> observe(
     std::shared_ptr<CompositeInstruction> program) {
   return obs->observe(program);
 }
+
+std::vector<double> observe_batch(
+    std::shared_ptr<xacc::Observable> obs,
+    std::vector<std::shared_ptr<CompositeInstruction>> &programs,
+    xacc::internal_compiler::qreg &q, std::vector<double> &variances) {
+  // Build the measurement basis circuits (basis change + measure)
+  // once by observing an empty placeholder kernel
+  const std::string placeholder_name = "__qcor_observe_batch_placeholder";
+  auto placeholder = create_composite(placeholder_name);
+  double identity_coeff = 0.0;
+  std::vector<double> coefficients;
+  std::vector<std::string> term_names;
+  std::vector<std::vector<std::shared_ptr<xacc::Instruction>>> term_bases;
+  for (auto &basis_kernel : obs->observe(placeholder)) {
+    std::vector<std::shared_ptr<xacc::Instruction>> basis;
+    for (auto &inst : basis_kernel->getInstructions()) {
+      if (inst->name() != placeholder_name) {
+        basis.push_back(inst);
+      }
+    }
+    const auto coeff = std::real(basis_kernel->getCoefficient());
+    if (basis.empty()) {
+      identity_coeff += coeff;
+    } else {
+      coefficients.push_back(coeff);
+      term_names.push_back(basis_kernel->name());
+      term_bases.push_back(basis);
+    }
+  }
+
+  // Attach each program to every measurement basis. The basis instructions
+  // are cloned per circuit: placements and passes may remap bits in place.
+  auto provider = get_provider();
+  std::vector<std::shared_ptr<CompositeInstruction>> all_circuits;
+  all_circuits.reserve(programs.size() * term_bases.size());
+  for (std::size_t i = 0; i < programs.size(); i++) {
+    for (std::size_t k = 0; k < term_bases.size(); k++) {
+      auto circuit = provider->createComposite(term_names[k] + "_" +
+                                               std::to_string(i));
+      circuit->addInstruction(programs[i]);
+      for (auto &inst : term_bases[k]) {
+        circuit->addInstruction(inst->clone());
+      }
+      all_circuits.push_back(circuit);
+    }
+  }
+
+  std::vector<double> energies(programs.size(), identity_coeff);
+  variances.assign(programs.size(), 0.0);
+  if (all_circuits.empty()) {
+    return energies;
+  }
+
+  auto tmp_buffer = qalloc(q.size());
+  xacc::internal_compiler::execute(tmp_buffer.results(), all_circuits);
+  auto children = tmp_buffer.results()->getChildren();
+  if (children.size() != all_circuits.size()) {
+    xacc::error("observe_batch: execution returned " +
+                std::to_string(children.size()) + " results, expected " +
+                std::to_string(all_circuits.size()));
+  }
+
+  for (std::size_t i = 0; i < programs.size(); i++) {
+    for (std::size_t k = 0; k < term_bases.size(); k++) {
+      auto &child = children[i * term_bases.size() + k];
+      const double exp_val = child->getExpectationValueZ();
+      energies[i] += coefficients[k] * exp_val;
+      // Single-shot variance of a Pauli measurement is 1 - <P>^2
+      int shots = 0;
+      for (auto &[bits, count] : child->getMeasurementCounts()) {
+        shots += count;
+      }
+      if (shots > 0) {
+        variances[i] += coefficients[k] * coefficients[k] *
+                        (1.0 - exp_val * exp_val) / shots;
+      }
+    }
+  }
+  return energies;
+}
 }  // namespace __internal__
 
 double observe(std::shared_ptr<CompositeInstruction> program,
@@ -103,8 +103,79 @@ namespace __internal__ {
 std::vector<std::shared_ptr<CompositeInstruction>>
 observe(std::shared_ptr<Observable> obs,
         std::shared_ptr<CompositeInstruction> program);
+
+// Observe all programs in a single execution, the measurement basis
+// circuits are constructed only once. Returns the expected value for each
+// program and sets the estimated variance of each expected value.
+std::vector<double>
+observe_batch(std::shared_ptr<Observable> obs,
+              std::vector<std::shared_ptr<CompositeInstruction>> &programs,
+              xacc::internal_compiler::qreg &q, std::vector<double> &variances);
 } // namespace __internal__
 
+// Public batched observe function, returns the expected value of the
+// Observable for each of the kernel argument sets. All evaluations are
+// submitted together as one batch. The variance of each estimate
+// (zero for exact simulation) is returned in variances.
+template <typename... Args>
+std::vector<double>
+observe_batch(void (*quantum_kernel_functor)(
+                  std::shared_ptr<CompositeInstruction>, Args...),
+              std::shared_ptr<Observable> obs,
+              const std::vector<std::tuple<Args...>> &args_list,
+              std::vector<double> &variances) {
+  variances.clear();
+  if (args_list.empty()) {
+    return {};
+  }
+
+  std::vector<std::shared_ptr<CompositeInstruction>> programs;
+  for (auto &args : args_list) {
+    auto program = qcor::__internal__::create_composite("observe_qkernel");
+    std::apply(
+        [&](auto... unpacked) { quantum_kernel_functor(program, unpacked...); },
+        args);
+    programs.push_back(program);
+  }
+
+  // Get the first argument, which should be a qreg
+  auto q = std::get<0>(args_list[0]);
+  return __internal__::observe_batch(obs, programs, q, variances);
+}
+
+template <typename... Args>
+std::vector<double>
+observe_batch(void (*quantum_kernel_functor)(
+                  std::shared_ptr<CompositeInstruction>, Args...),
+              std::shared_ptr<Observable> obs,
+              const std::vector<std::tuple<Args...>> &args_list) {
+  std::vector<double> variances;
+  return observe_batch(quantum_kernel_functor, obs, args_list, variances);
+}
+
+template <typename... Args>
+std::vector<double>
+observe_batch(void (*quantum_kernel_functor)(
+                  std::shared_ptr<CompositeInstruction>, Args...),
+              Observable &obs, const std::vector<std::tuple<Args...>> &args_list,
+              std::vector<double> &variances) {
+  return observe_batch(quantum_kernel_functor,
+                       __internal__::qcor_as_shared(&obs), args_list,
+                       variances);
+}
+
+template <typename... Args>
+std::vector<double>
+observe_batch(void (*quantum_kernel_functor)(
+                  std::shared_ptr<CompositeInstruction>, Args...),
+              Observable &obs,
+              const std::vector<std::tuple<Args...>> &args_list) {
+  std::vector<double> variances;
+  return observe_batch(quantum_kernel_functor,
+                       __internal__::qcor_as_shared(&obs), args_list,
+                       variances);
+}
+
 // Create an observable from a string representation
 std::shared_ptr<Observable> createObservable(const std::string &repr);
 std::shared_ptr<Observable> createObservable(const std::string& name, const std::string &repr);
@@ -116,7 +187,15 @@ std::shared_ptr<Observable> createOperator(const std::string& name, const std::s
 std::shared_ptr<Observable> createOperator(const std::string &name, HeterogeneousMap&& options);
 std::shared_ptr<Observable> createOperator(const std::string &name, HeterogeneousMap& options);
 
+// Transform an operator (e.g. "jw" or "bk" fermion-to-qubit mappings).
+// Transformed Pauli operators are cached in memory and on disk, keyed by
+// the transform name and the input operator (disk entries are named after
+// a hash of the input and store it for verification). The disk cache
+// directory is $QCOR_TRANSFORM_CACHE_DIR (disabled if set to an empty
+// string), default $HOME/.qcor_transform_cache.
 std::shared_ptr<Observable> operatorTransform(const std::string& type, qcor::Observable& op);
 std::shared_ptr<Observable> operatorTransform(const std::string& type, std::shared_ptr<Observable> op);
+// Clear the in-memory transform cache, and optionally the disk cache.
+void clearTransformCache(bool clear_disk = false);
 
 } // namespace qcor
\ No newline at end of file
@@ -2,11 +2,11 @@
 #include <Utils.hpp>
 
 #include "FermionOperator.hpp"
-#include "ObservableTransform.hpp"
 #include "PauliOperator.hpp"
 #include "cppmicroservices/BundleActivator.h"
 #include "cppmicroservices/BundleContext.h"
 #include "cppmicroservices/ServiceProperties.h"
+#include "qcor_observable.hpp"
 #include "qrt.hpp"
 #include "xacc.hpp"
 #include "xacc_internal_compiler.hpp"
@@ -147,13 +147,13 @@ class NISQ : public ::quantum::QuantumRuntime {
     std::unordered_map<std::string, xacc::quantum::Term> terms;
 
     auto obs_str = Hptr_input->toString();
-    auto fermi_to_pauli = xacc::getService<xacc::ObservableTransform>("jw");
+    // Cached Jordan-Wigner transform
     std::shared_ptr<xacc::Observable> Hptr;
     if (ptr_is_a<xacc::quantum::FermionOperator>(Hptr_input)) {
-      Hptr = fermi_to_pauli->transform(Hptr_input);
+      Hptr = operatorTransform("jw", Hptr_input);
     } else if (obs_str.find("^") != std::string::npos) {
       auto fermionObservable = xacc::quantum::getObservable("fermion", obs_str);
-      Hptr = fermi_to_pauli->transform(fermionObservable);
+      Hptr = operatorTransform("jw", fermionObservable);
     } else if (ptr_is_a<xacc::quantum::PauliOperator>(Hptr_input)) {
       Hptr = Hptr_input;
     } else if (obs_str.find("X") != std::string::npos ||
@@ -22,14 +22,10 @@ std::string __placement_name = "";
 std::vector<int> __qubit_map = {};
 std::string __qrt_env = "nisq";
 
-void execute_pass_manager(
-    std::shared_ptr<CompositeInstruction> optional_composite) {
-  qcor::internal::PassManager passManager(__opt_level, __qubit_map,
-                                          __placement_name);
-  auto kernelToExecute = optional_composite
-                             ? optional_composite
-                             : ::quantum::qrt_impl->get_current_program();
-  auto optData = passManager.optimize(kernelToExecute);
+void execute_optimization_passes(
+    std::shared_ptr<CompositeInstruction> composite) {
+  qcor::internal::PassManager passManager(__opt_level);
+  auto optData = passManager.optimize(composite);
 
   std::vector<std::string> user_passes;
   if (!__user_opt_passes.empty()) {
@@ -45,7 +41,7 @@ void execute_pass_manager(
   // Runs user-specified passes
   for (const auto &user_pass : user_passes) {
     optData.emplace_back(
-        qcor::internal::PassManager::runPass(user_pass, kernelToExecute));
+        qcor::internal::PassManager::runPass(user_pass, composite));
   }
 
   if (__print_opt_stats) {
@@ -54,7 +50,16 @@ void execute_pass_manager(
       std::cout << passData.toString(false);
     }
   }
+}
 
+void execute_pass_manager(
+    std::shared_ptr<CompositeInstruction> optional_composite) {
+  auto kernelToExecute = optional_composite
+                             ? optional_composite
+                             : ::quantum::qrt_impl->get_current_program();
+  execute_optimization_passes(kernelToExecute);
+  qcor::internal::PassManager passManager(__opt_level, __qubit_map,
+                                          __placement_name);
   passManager.applyPlacement(kernelToExecute);
 }
 
@@ -195,6 +195,10 @@ extern std::string __qrt_env;
 // If none provided, execute the pass manager on the current QRT kernel.
 void execute_pass_manager(
     std::shared_ptr<CompositeInstruction> optional_composite = nullptr);
+// Optimization part of execute_pass_manager (optimization level and
+// user-specified passes, stats), no placement.
+void execute_optimization_passes(
+    std::shared_ptr<CompositeInstruction> composite);
 
 } // namespace internal_compiler
 } // namespace xacc
@@ -1,6 +1,15 @@
 #include "qcor.hpp"
+#include "qcor_diagonal_qaoa.hpp"
+#include "qcor_state_vector.hpp"
 
+#include "Accelerator.hpp"
+#include "AlgorithmGradientStrategy.hpp"
+#include "ObservableTransform.hpp"
+#include "xacc_service.hpp"
+#include <cmath>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <unistd.h>
 
 using namespace xacc;
 using namespace qcor;
@@ -110,6 +119,221 @@ TEST(QCORTester, checkTaskInitiate) {
   EXPECT_NEAR(-1.748865, results5.opt_val, 1e-4);
 }
 
+TEST(QCORTester, checkAdjointGradient) {
+  ::quantum::initialize("qpp", "empty");
+
+  auto H = qcor::createObservable(
+      std::string("5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1"));
+  auto ansatz = qcor::compile(R"(__qpu__ void adjoint_ansatz(qbit q, double t) {
+      X(q[0]);
+      Ry(q[1], t);
+      CX(q[1], q[0]);
+    })");
+
+  // E(t) = 5.907 - 4.2866 sin(t) - 6.34329 cos(t)
+  qcor::StateVector psi(2);
+  psi.apply((*ansatz)({0.2}));
+  EXPECT_NEAR(-1.161462, psi.expectation(*std::dynamic_pointer_cast<PauliOperator>(H)), 1e-4);
+
+  auto adjoint = xacc::getService<xacc::AlgorithmGradientStrategy>("adjoint");
+  adjoint->initialize({{"observable", H}});
+  std::vector<double> dx(1);
+  EXPECT_TRUE(adjoint->getGradientExecutions(ansatz, {0.2}).empty());
+  adjoint->compute(dx, {});
+  EXPECT_NEAR(-2.940936, dx[0], 1e-4);
+
+  adjoint->getGradientExecutions(ansatz, {0.594});
+  adjoint->compute(dx, {});
+  EXPECT_NEAR(0.0, dx[0], 1e-2);
+}
+
+TEST(QCORTester, checkOptimizationHistory) {
+  const std::string filename = "qcor_history_test.csv";
+  std::remove(filename.c_str());
+  {
+    qcor::OptimizationHistory history(3, filename);
+    for (int i = 0; i < 5; i++) {
+      history.record({i, {0.1 * i}, -1.0 * i, 0.0, 1.0});
+    }
+    EXPECT_EQ(3, history.size());
+    EXPECT_EQ(5, history.total_recorded());
+    auto entries = history.entries();
+    EXPECT_EQ(2, entries[0].iteration);
+    EXPECT_EQ(4, entries[2].iteration);
+    EXPECT_EQ(4, history.last().iteration);
+    EXPECT_NEAR(-4.0, history.last().energy, 1e-12);
+  }
+
+  // All entries were streamed to disk
+  std::ifstream file(filename);
+  std::string line;
+  int n_lines = 0;
+  while (std::getline(file, line)) {
+    n_lines++;
+  }
+  EXPECT_EQ(5, n_lines);
+  std::remove(filename.c_str());
+}
+
+TEST(QCORTester, checkDiagonalQaoa) {
+  ::quantum::initialize("qpp", "empty");
+  auto H = 1.5 + 0.7 * qcor::Z(0) * qcor::Z(1) - 1.1 * qcor::Z(1) * qcor::Z(2) +
+           0.3 * qcor::Z(0);
+  qcor::DiagonalQaoaSimulator simulator(H);
+  EXPECT_EQ(3, simulator.n_qubits());
+  EXPECT_EQ(3, simulator.n_mixer_terms());
+  // |000>: 1.5 + 0.7 - 1.1 + 0.3, |011>: 1.5 - 0.7 + 1.1 - 0.3
+  EXPECT_NEAR(1.4, simulator.cost_vector()[0], 1e-12);
+  EXPECT_NEAR(1.6, simulator.cost_vector()[3], 1e-12);
+
+  // Reference: the same 2-step QAOA circuit on the state-vector simulator
+  const std::vector<double> x{0.3, 0.7, -0.4, 0.25};
+  auto provider = xacc::getIRProvider("quantum");
+  auto circuit = provider->createComposite("qaoa_reference");
+  for (std::size_t i = 0; i < 3; i++) {
+    circuit->addInstruction(provider->createInstruction("H", {i}));
+  }
+  for (int step = 0; step < 2; step++) {
+    const double gamma = x[2 * step];
+    const double beta = x[2 * step + 1];
+    for (auto [bits, coeff] :
+         std::vector<std::pair<std::vector<std::size_t>, double>>{
+             {{0, 1}, 0.7}, {{1, 2}, -1.1}}) {
+      circuit->addInstruction(provider->createInstruction("CNOT", bits));
+      circuit->addInstruction(
+          provider->createInstruction("Rz", {bits[1]}, {2.0 * gamma * coeff}));
+      circuit->addInstruction(provider->createInstruction("CNOT", bits));
+    }
+    circuit->addInstruction(
+        provider->createInstruction("Rz", {0}, {2.0 * gamma * 0.3}));
+    for (std::size_t i = 0; i < 3; i++) {
+      circuit->addInstruction(
+          provider->createInstruction("Rx", {i}, {2.0 * beta}));
+    }
+  }
+  qcor::StateVector psi(3);
+  psi.apply(circuit);
+
+  std::vector<double> dx(x.size());
+  const double energy = simulator.expectation(x, dx);
+  EXPECT_NEAR(psi.expectation(H), energy, 1e-9);
+
+  // Adjoint gradient vs. central finite difference
+  for (std::size_t i = 0; i < x.size(); i++) {
+    auto x_plus = x, x_minus = x;
+    x_plus[i] += 1e-5;
+    x_minus[i] -= 1e-5;
+    std::vector<double> empty;
+    const double fd = (simulator.expectation(x_plus, empty) -
+                       simulator.expectation(x_minus, empty)) /
+                      2e-5;
+    EXPECT_NEAR(fd, dx[i], 1e-6);
+  }
+
+  // Non-diagonal cost Hamiltonians are rejected.
+  auto xx = qcor::X(0) * qcor::X(1);
+  EXPECT_FALSE(qcor::DiagonalQaoaSimulator::is_diagonal(xx));
+}
+
+TEST(QCORTester, checkTransformCache) {
+  ::quantum::initialize("qpp", "empty");
+  const std::string cache_dir = "qcor_transform_cache_test";
+  setenv("QCOR_TRANSFORM_CACHE_DIR", cache_dir.c_str(), 1);
+  qcor::clearTransformCache(true);
+
+  auto H = qcor::createObservable("fermion", "0.5 0^ 1 + 0.5 1^ 0 + 0.25 2^ 2");
+  auto expected = std::dynamic_pointer_cast<PauliOperator>(
+      xacc::getService<xacc::ObservableTransform>("jw")->transform(H));
+  const auto check = [&](std::shared_ptr<Observable> result) {
+    auto pauli = std::dynamic_pointer_cast<PauliOperator>(result);
+    EXPECT_TRUE(pauli != nullptr);
+    EXPECT_EQ(expected->getTerms().size(), pauli->getTerms().size());
+    for (auto &[term_str, term] : expected->getTerms()) {
+      EXPECT_NEAR(std::abs(term.coeff() - pauli->getTerms()[term_str].coeff()),
+                  0.0, 1e-12);
+    }
+  };
+  // Computed, then from memory, then from disk.
+  check(qcor::operatorTransform("jw", H));
+  check(qcor::operatorTransform("jw", H));
+  qcor::clearTransformCache();
+  check(qcor::operatorTransform("jw", H));
+
+  qcor::clearTransformCache(true);
+  unsetenv("QCOR_TRANSFORM_CACHE_DIR");
+  rmdir(cache_dir.c_str());
+}
+
+// Runs the circuits on another accelerator, counting the executions
+class CountingAccelerator : public xacc::Accelerator {
+public:
+  std::shared_ptr<xacc::Accelerator> impl;
+  int n_executions = 0;
+  int n_circuits = 0;
+  CountingAccelerator(std::shared_ptr<xacc::Accelerator> accelerator)
+      : impl(accelerator) {}
+  const std::string name() const override { return "counting"; }
+  const std::string description() const override { return ""; }
+  void initialize(const HeterogeneousMap &params = {}) override {
+    impl->initialize(params);
+  }
+  void updateConfiguration(const HeterogeneousMap &config) override {
+    impl->updateConfiguration(config);
+  }
+  const std::vector<std::string> configurationKeys() override {
+    return impl->configurationKeys();
+  }
+  BitOrder getBitOrder() override { return impl->getBitOrder(); }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::shared_ptr<CompositeInstruction> program) override {
+    n_executions++;
+    n_circuits++;
+    impl->execute(buffer, program);
+  }
+  void execute(std::shared_ptr<AcceleratorBuffer> buffer,
+               const std::vector<std::shared_ptr<CompositeInstruction>>
+                   programs) override {
+    n_executions++;
+    n_circuits += programs.size();
+    impl->execute(buffer, programs);
+  }
+};
+
+TEST(QCORTester, checkGatherStatisticsBatches) {
+  ::quantum::initialize("qpp", "empty");
+  auto qpu = std::make_shared<CountingAccelerator>(
+      xacc::getAccelerator("qpp", {std::make_pair("shots", 1024)}));
+  xacc::internal_compiler::qpu = qpu;
+
+  auto buffer = qalloc(2);
+  std::shared_ptr<Observable> observable = qcor::createObservable(
+      std::string("5.907 - 2.1433 X0X1 - 2.1433 Y0Y1 + .21829 Z0 - 6.125 Z1"));
+  auto objective = qcor::createObjectiveFunction(rucc, observable, buffer, 1,
+                                                 {{"history-size", 10}});
+  // Single evaluation: one execution of the measured terms
+  (*objective)({0.594});
+  const int n_terms = qpu->n_circuits;
+  EXPECT_EQ(1, qpu->n_executions);
+
+  // 10 samples: the first evaluation, then 9 repetitions in batches of 4
+  HeterogeneousMap options{{"history-size", 10},
+                           {"vqe-gather-statistics", 10},
+                           {"vqe-gather-statistics-batch-size", 4}};
+  objective->set_options(options);
+  (*objective)({0.594});
+  EXPECT_EQ(1 + 1 + 3, qpu->n_executions);
+  EXPECT_EQ(n_terms + 10 * n_terms, qpu->n_circuits);
+
+  auto history = objective->get_history();
+  EXPECT_EQ(2, history->size());
+  const auto entry = history->last();
+  EXPECT_TRUE(std::isfinite(entry.energy));
+  EXPECT_TRUE(std::isfinite(entry.stddev));
+  // Sampling noise (1024 shots) around the minimum energy
+  EXPECT_GT(entry.stddev, 0.0);
+  EXPECT_NEAR(-1.748865, entry.energy, 0.3);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   auto ret = RUN_ALL_TESTS();
@@ -0,0 +1,299 @@
+#include "qcor_diagonal_qaoa.hpp"
+
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+
+#include <cmath>
+#include <map>
+#include <string>
+
+namespace qcor {
+namespace {
+using PauliOps = std::map<int, std::string>;
+
+// (coefficient, ops) of each non-identity term, in getNonIdentitySubTerms()
+// order (i.e. the order used for per-term parameters).
+std::vector<std::pair<double, PauliOps>>
+get_terms(xacc::quantum::PauliOperator &op) {
+  std::vector<std::pair<double, PauliOps>> terms;
+  for (auto &sub_term : op.getNonIdentitySubTerms()) {
+    auto pauli =
+        std::dynamic_pointer_cast<xacc::quantum::PauliOperator>(sub_term);
+    for (auto &[termStr, term] : pauli->getTerms()) {
+      PauliOps ops;
+      for (auto &[bitIdx, pauliOpStr] : term.ops()) {
+        if (pauliOpStr != "I") {
+          ops[bitIdx] = pauliOpStr;
+        }
+      }
+      terms.emplace_back(std::real(term.coeff()), ops);
+    }
+  }
+  return terms;
+}
+
+double parity_sign(std::size_t i, std::size_t mask) {
+  return (__builtin_popcountll(i & mask) % 2) ? -1.0 : 1.0;
+}
+
+// Im(<a|b>)
+double imag_inner(const std::vector<std::complex<double>> &a,
+                  const std::vector<std::complex<double>> &b) {
+  std::complex<double> result = 0.0;
+  for (std::size_t i = 0; i < a.size(); i++) {
+    result += std::conj(a[i]) * b[i];
+  }
+  return std::imag(result);
+}
+
+
+xacc::quantum::PauliOperator x_mixer(int nbQubits) {
+  xacc::quantum::PauliOperator mixer;
+  for (int i = 0; i < nbQubits; i++) {
+    mixer += xacc::quantum::PauliOperator({{i, "X"}});
+  }
+  return mixer;
+}
+} // namespace
+
+DiagonalQaoaSimulator::DiagonalQaoaSimulator(
+    xacc::quantum::PauliOperator &cost)
+    : DiagonalQaoaSimulator(cost, x_mixer(cost.nBits())) {}
+
+DiagonalQaoaSimulator::DiagonalQaoaSimulator(
+    xacc::quantum::PauliOperator &cost, xacc::quantum::PauliOperator mixer) {
+  if (!is_diagonal(cost)) {
+    xacc::error("DiagonalQaoaSimulator: the cost Hamiltonian must only "
+                "contain Z terms.");
+  }
+  if (!is_x_mixer(mixer)) {
+    xacc::error("DiagonalQaoaSimulator: the mixer Hamiltonian must be a sum "
+                "of single-qubit X terms.");
+  }
+
+  m_nbQubits = std::max(cost.nBits(), mixer.nBits());
+  for (auto &[coeff, ops] : get_terms(cost)) {
+    std::size_t mask = 0;
+    for (auto &[bitIdx, pauliOpStr] : ops) {
+      mask |= 1ULL << bitIdx;
+    }
+    m_costMasks.emplace_back(mask);
+    m_costCoeffs.emplace_back(coeff);
+  }
+  if (cost.getIdentitySubTerm()) {
+    m_identityCoeff = std::real(cost.getIdentitySubTerm()->coefficient());
+  }
+  for (auto &[coeff, ops] : get_terms(mixer)) {
+    m_mixerQubits.emplace_back(ops.begin()->first);
+    m_mixerCoeffs.emplace_back(coeff);
+  }
+
+  // C(i) = sum_m a_m (-1)^{|i & m|} is the Walsh-Hadamard transform of the
+  // coefficients indexed by Z-mask: O(n 2^n) regardless of the number
+  // of terms.
+  const std::size_t dim = 1ULL << m_nbQubits;
+  m_costVector.assign(dim, 0.0);
+  m_costVector[0] = m_identityCoeff;
+  for (std::size_t t = 0; t < m_costMasks.size(); t++) {
+    m_costVector[m_costMasks[t]] += m_costCoeffs[t];
+  }
+  for (std::size_t half = 1; half < dim; half <<= 1) {
+    for (std::size_t i = 0; i < dim; i += 2 * half) {
+      for (std::size_t j = i; j < i + half; j++) {
+        const double a = m_costVector[j];
+        const double b = m_costVector[j + half];
+        m_costVector[j] = a + b;
+        m_costVector[j + half] = a - b;
+      }
+    }
+  }
+}
+
+bool DiagonalQaoaSimulator::is_diagonal(xacc::quantum::PauliOperator &op) {
+  for (auto &[coeff, ops] : get_terms(op)) {
+    for (auto &[bitIdx, pauliOpStr] : ops) {
+      if (pauliOpStr != "Z") {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool DiagonalQaoaSimulator::is_x_mixer(xacc::quantum::PauliOperator &op) {
+  for (auto &[coeff, ops] : get_terms(op)) {
+    if (ops.size() != 1 || ops.begin()->second != "X") {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DiagonalQaoaSimulator::apply_cost(State &state,
+                                       const std::vector<double> &gammas,
+                                       double sign) const {
+  // The identity term only contributes a global phase.
+  if (gammas.size() == 1) {
+    const double gamma = sign * gammas[0];
+    for (std::size_t i = 0; i < state.size(); i++) {
+      state[i] *= std::polar(1.0, -gamma * (m_costVector[i] - m_identityCoeff));
+    }
+    return;
+  }
+
+  if (gammas.size() != m_costMasks.size()) {
+    xacc::error("DiagonalQaoaSimulator: expected 1 or " +
+                std::to_string(m_costMasks.size()) + " gamma angles, got " +
+                std::to_string(gammas.size()));
+  }
+  for (std::size_t i = 0; i < state.size(); i++) {
+    double phase = 0.0;
+    for (std::size_t t = 0; t < m_costMasks.size(); t++) {
+      phase += gammas[t] * m_costCoeffs[t] * parity_sign(i, m_costMasks[t]);
+    }
+    state[i] *= std::polar(1.0, -sign * phase);
+  }
+}
+
+void DiagonalQaoaSimulator::apply_mixer(State &state,
+                                        const std::vector<double> &betas,
+                                        double sign) const {
+  if (betas.size() != 1 && betas.size() != m_mixerQubits.size()) {
+    xacc::error("DiagonalQaoaSimulator: expected 1 or " +
+                std::to_string(m_mixerQubits.size()) + " beta angles, got " +
+                std::to_string(betas.size()));
+  }
+  // exp(-i theta X_q) on every (i, i | bit_q) pair
+  for (std::size_t t = 0; t < m_mixerQubits.size(); t++) {
+    const double beta = (betas.size() == 1) ? betas[0] : betas[t];
+    const double theta = sign * beta * m_mixerCoeffs[t];
+    const double c = std::cos(theta);
+    const std::complex<double> s(0.0, -std::sin(theta));
+    const std::size_t bit = 1ULL << m_mixerQubits[t];
+    for (std::size_t i = 0; i < state.size(); i++) {
+      if (!(i & bit)) {
+        const auto a = state[i];
+        const auto b = state[i | bit];
+        state[i] = c * a + s * b;
+        state[i | bit] = s * a + c * b;
+      }
+    }
+  }
+}
+
+std::vector<double>
+DiagonalQaoaSimulator::cost_gradients(const State &lambda, const State &psi,
+                                      const std::vector<double> &gammas) const {
+  // dE/dgamma = 2 Im <lambda| G |psi>, G the generator of the layer
+  if (gammas.size() == 1) {
+    State g_psi(psi.size());
+    for (std::size_t i = 0; i < psi.size(); i++) {
+      g_psi[i] = (m_costVector[i] - m_identityCoeff) * psi[i];
+    }
+    return {2.0 * imag_inner(lambda, g_psi)};
+  }
+
+  std::vector<double> grads;
+  for (std::size_t t = 0; t < m_costMasks.size(); t++) {
+    std::complex<double> inner = 0.0;
+    for (std::size_t i = 0; i < psi.size(); i++) {
+      inner += std::conj(lambda[i]) * psi[i] * m_costCoeffs[t] *
+               parity_sign(i, m_costMasks[t]);
+    }
+    grads.emplace_back(2.0 * std::imag(inner));
+  }
+  return grads;
+}
+
+std::vector<double>
+DiagonalQaoaSimulator::mixer_gradients(const State &lambda, const State &psi,
+                                       const std::vector<double> &betas) const {
+  std::vector<double> term_grads;
+  for (std::size_t t = 0; t < m_mixerQubits.size(); t++) {
+    const std::size_t bit = 1ULL << m_mixerQubits[t];
+    std::complex<double> inner = 0.0;
+    for (std::size_t i = 0; i < psi.size(); i++) {
+      inner += std::conj(lambda[i]) * m_mixerCoeffs[t] * psi[i ^ bit];
+    }
+    term_grads.emplace_back(2.0 * std::imag(inner));
+  }
+  if (betas.size() == 1) {
+    double sum = 0.0;
+    for (auto &g : term_grads) {
+      sum += g;
+    }
+    return {sum};
+  }
+  return term_grads;
+}
+
+double DiagonalQaoaSimulator::expectation(
+    const std::vector<std::vector<double>> &gammas,
+    const std::vector<std::vector<double>> &betas,
+    std::vector<std::vector<double>> *gamma_grads,
+    std::vector<std::vector<double>> *beta_grads) const {
+  if (gammas.size() != betas.size()) {
+    xacc::error("DiagonalQaoaSimulator: gamma and beta layers mismatch.");
+  }
+  const std::size_t dim = m_costVector.size();
+  // |+...+>
+  State psi(dim, std::complex<double>(1.0 / std::sqrt((double)dim), 0.0));
+  for (std::size_t k = 0; k < gammas.size(); k++) {
+    apply_cost(psi, gammas[k], 1.0);
+    apply_mixer(psi, betas[k], 1.0);
+  }
+
+  double energy = 0.0;
+  for (std::size_t i = 0; i < dim; i++) {
+    energy += std::norm(psi[i]) * m_costVector[i];
+  }
+  if (!gamma_grads && !beta_grads) {
+    return energy;
+  }
+
+  // Adjoint method: backward sweep with |lambda> = C|psi>
+  State lambda(dim);
+  for (std::size_t i = 0; i < dim; i++) {
+    lambda[i] = m_costVector[i] * psi[i];
+  }
+  std::vector<std::vector<double>> d_gammas(gammas.size()),
+      d_betas(betas.size());
+  for (std::size_t k = gammas.size(); k-- > 0;) {
+    d_betas[k] = mixer_gradients(lambda, psi, betas[k]);
+    apply_mixer(psi, betas[k], -1.0);
+    apply_mixer(lambda, betas[k], -1.0);
+    d_gammas[k] = cost_gradients(lambda, psi, gammas[k]);
+    apply_cost(psi, gammas[k], -1.0);
+    apply_cost(lambda, gammas[k], -1.0);
+  }
+  if (gamma_grads) {
+    *gamma_grads = d_gammas;
+  }
+  if (beta_grads) {
+    *beta_grads = d_betas;
+  }
+  return energy;
+}
+
+double DiagonalQaoaSimulator::expectation(const std::vector<double> &x,
+                                          std::vector<double> &dx) const {
+  if (x.size() % 2 != 0) {
+    xacc::error("DiagonalQaoaSimulator: expected [gamma, beta] pairs.");
+  }
+  std::vector<std::vector<double>> gammas, betas;
+  for (std::size_t k = 0; k < x.size() / 2; k++) {
+    gammas.push_back({x[2 * k]});
+    betas.push_back({x[2 * k + 1]});
+  }
+  if (dx.empty()) {
+    return expectation(gammas, betas);
+  }
+  std::vector<std::vector<double>> d_gammas, d_betas;
+  const double energy = expectation(gammas, betas, &d_gammas, &d_betas);
+  for (std::size_t k = 0; k < x.size() / 2; k++) {
+    dx[2 * k] = d_gammas[k][0];
+    dx[2 * k + 1] = d_betas[k][0];
+  }
+  return energy;
+}
+} // namespace qcor
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace xacc {
+namespace quantum {
+class PauliOperator;
+}
+} // namespace xacc
+
+namespace qcor {
+
+// Exact QAOA simulator for diagonal (Z-only) cost Hamiltonians,
+// e.g. MaxCut or Ising problems. The cost C is precomputed once as a
+// vector of 2^n values (fast Walsh-Hadamard transform of the term
+// coefficients), cost layers exp(-i gamma C) are applied as elementwise
+// phases and mixer layers exp(-i beta sum_j c_j X_j) as X rotations.
+// <C> is computed exactly from the final state.
+//
+// Layer angles: gammas[k] holds either one angle for the whole cost
+// Hamiltonian or one angle per (non-identity) cost term, betas[k] holds
+// either one angle for the whole mixer or one angle per mixer term.
+// Qubit i is mapped to bit i of the amplitude index (little-endian).
+class DiagonalQaoaSimulator {
+public:
+  // Mixer sum_j X_j on all qubits of the cost Hamiltonian
+  DiagonalQaoaSimulator(xacc::quantum::PauliOperator &cost);
+  // Mixer must be a sum of single-qubit X terms.
+  DiagonalQaoaSimulator(xacc::quantum::PauliOperator &cost,
+                        xacc::quantum::PauliOperator mixer);
+
+  // Return true if the operator only contains Z (and identity) terms
+  static bool is_diagonal(xacc::quantum::PauliOperator &op);
+  // Return true if the operator is a sum of single-qubit X terms
+  static bool is_x_mixer(xacc::quantum::PauliOperator &op);
+
+  std::size_t n_qubits() const { return m_nbQubits; }
+  std::size_t n_cost_terms() const { return m_costMasks.size(); }
+  std::size_t n_mixer_terms() const { return m_mixerQubits.size(); }
+  // C(i) for every computational basis state i (including identity terms)
+  const std::vector<double> &cost_vector() const { return m_costVector; }
+
+  // Return <C> after the QAOA layers. The gradient w.r.t. every angle
+  // is computed by the adjoint method if the output pointers are provided.
+  double expectation(const std::vector<std::vector<double>> &gammas,
+                     const std::vector<std::vector<double>> &betas,
+                     std::vector<std::vector<double>> *gamma_grads = nullptr,
+                     std::vector<std::vector<double>> *beta_grads =
+                         nullptr) const;
+
+  // Standard parameterization: x = [gamma_0, beta_0, gamma_1, beta_1, ...]
+  double expectation(const std::vector<double> &x,
+                     std::vector<double> &dx) const;
+
+private:
+  using State = std::vector<std::complex<double>>;
+  void apply_cost(State &state, const std::vector<double> &gammas,
+                  double sign) const;
+  void apply_mixer(State &state, const std::vector<double> &betas,
+                   double sign) const;
+  std::vector<double> cost_gradients(const State &lambda, const State &psi,
+                                     const std::vector<double> &gammas) const;
+  std::vector<double> mixer_gradients(const State &lambda, const State &psi,
+                                      const std::vector<double> &betas) const;
+
+  std::size_t m_nbQubits;
+  // Z-mask and coefficient of each non-identity cost term
+  std::vector<std::size_t> m_costMasks;
+  std::vector<double> m_costCoeffs;
+  double m_identityCoeff = 0.0;
+  std::vector<double> m_costVector;
+  // Qubit and coefficient of each mixer X term
+  std::vector<std::size_t> m_mixerQubits;
+  std::vector<double> m_mixerCoeffs;
+};
+} // namespace qcor
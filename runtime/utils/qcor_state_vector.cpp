@@ -0,0 +1,311 @@
+#include "qcor_state_vector.hpp"
+
+#include "InstructionIterator.hpp"
+#include "PauliOperator.hpp"
+#include "xacc.hpp"
+
+#include <set>
+
+namespace qcor {
+namespace {
+constexpr std::complex<double> I_unit{0.0, 1.0};
+
+const std::set<std::string> SINGLE_QUBIT_GATES{
+    "H", "X", "Y", "Z", "S", "Sdg", "T", "Tdg", "I", "Rx", "Ry", "Rz", "U1", "U"};
+const std::set<std::string> TWO_QUBIT_GATES{"CNOT", "CY",  "CZ",    "CH",
+                                            "Swap", "CRZ", "CPhase"};
+// Map controlled gates to the gate acting on the target
+const std::map<std::string, std::string> CONTROLLED_TARGETS{
+    {"CNOT", "X"}, {"CY", "Y"},   {"CZ", "Z"},
+    {"CH", "H"},   {"CRZ", "Rz"}, {"CPhase", "U1"}};
+
+std::vector<double> get_parameters(std::shared_ptr<xacc::Instruction> inst) {
+  std::vector<double> params;
+  for (int i = 0; i < inst->nParameters(); i++) {
+    params.emplace_back(xacc::InstructionParameterToDouble(inst->getParameter(i)));
+  }
+  return params;
+}
+
+// Matrix U(params), or dU/d(params[k]) if derivative is set.
+Eigen::Matrix2cd single_qubit_matrix(const std::string &name,
+                                     const std::vector<double> &params,
+                                     bool derivative, std::size_t k) {
+  Eigen::Matrix2cd mat = Eigen::Matrix2cd::Zero();
+  if (derivative && (params.empty() || k >= params.size())) {
+    xacc::error("StateVector: cannot differentiate gate " + name +
+                " w.r.t. parameter " + std::to_string(k));
+  }
+
+  if (name == "H") {
+    mat << 1.0, 1.0, 1.0, -1.0;
+    mat /= std::sqrt(2.0);
+  } else if (name == "X") {
+    mat << 0.0, 1.0, 1.0, 0.0;
+  } else if (name == "Y") {
+    mat << 0.0, -I_unit, I_unit, 0.0;
+  } else if (name == "Z") {
+    mat << 1.0, 0.0, 0.0, -1.0;
+  } else if (name == "S") {
+    mat << 1.0, 0.0, 0.0, I_unit;
+  } else if (name == "Sdg") {
+    mat << 1.0, 0.0, 0.0, -I_unit;
+  } else if (name == "T") {
+    mat << 1.0, 0.0, 0.0, std::exp(I_unit * M_PI / 4.0);
+  } else if (name == "Tdg") {
+    mat << 1.0, 0.0, 0.0, std::exp(-I_unit * M_PI / 4.0);
+  } else if (name == "I") {
+    mat = Eigen::Matrix2cd::Identity();
+  } else if (name == "Rx") {
+    const double c = std::cos(params[0] / 2.0), s = std::sin(params[0] / 2.0);
+    if (derivative) {
+      mat << -0.5 * s, -0.5 * I_unit * c, -0.5 * I_unit * c, -0.5 * s;
+    } else {
+      mat << c, -I_unit * s, -I_unit * s, c;
+    }
+  } else if (name == "Ry") {
+    const double c = std::cos(params[0] / 2.0), s = std::sin(params[0] / 2.0);
+    if (derivative) {
+      mat << -0.5 * s, -0.5 * c, 0.5 * c, -0.5 * s;
+    } else {
+      mat << c, -s, s, c;
+    }
+  } else if (name == "Rz") {
+    const auto m = std::exp(-I_unit * params[0] / 2.0);
+    const auto p = std::exp(I_unit * params[0] / 2.0);
+    if (derivative) {
+      mat << -0.5 * I_unit * m, 0.0, 0.0, 0.5 * I_unit * p;
+    } else {
+      mat << m, 0.0, 0.0, p;
+    }
+  } else if (name == "U1") {
+    const auto p = std::exp(I_unit * params[0]);
+    if (derivative) {
+      mat << 0.0, 0.0, 0.0, I_unit * p;
+    } else {
+      mat << 1.0, 0.0, 0.0, p;
+    }
+  } else if (name == "U") {
+    const double c = std::cos(params[0] / 2.0), s = std::sin(params[0] / 2.0);
+    const auto e_phi = std::exp(I_unit * params[1]);
+    const auto e_lambda = std::exp(I_unit * params[2]);
+    if (!derivative) {
+      mat << c, -e_lambda * s, e_phi * s, e_phi * e_lambda * c;
+    } else if (k == 0) {
+      mat << -0.5 * s, -0.5 * e_lambda * c, 0.5 * e_phi * c,
+          -0.5 * e_phi * e_lambda * s;
+    } else if (k == 1) {
+      mat << 0.0, 0.0, I_unit * e_phi * s, I_unit * e_phi * e_lambda * c;
+    } else {
+      mat << 0.0, -I_unit * e_lambda * s, 0.0, I_unit * e_phi * e_lambda * c;
+    }
+  } else {
+    xacc::error("StateVector: unsupported gate " + name);
+  }
+
+  return mat;
+}
+
+Eigen::Matrix4cd two_qubit_matrix(const std::string &name,
+                                  const std::vector<double> &params,
+                                  bool derivative, std::size_t k) {
+  Eigen::Matrix4cd mat = Eigen::Matrix4cd::Zero();
+  if (name == "Swap") {
+    if (derivative) {
+      xacc::error("StateVector: cannot differentiate gate " + name);
+    }
+    mat(0, 0) = mat(1, 2) = mat(2, 1) = mat(3, 3) = 1.0;
+    return mat;
+  }
+
+  auto iter = CONTROLLED_TARGETS.find(name);
+  if (iter == CONTROLLED_TARGETS.end()) {
+    xacc::error("StateVector: unsupported gate " + name);
+  }
+  // |0><0| x I + |1><1| x U, derivative only acts on the U block
+  if (!derivative) {
+    mat.block<2, 2>(0, 0) = Eigen::Matrix2cd::Identity();
+  }
+  mat.block<2, 2>(2, 2) =
+      single_qubit_matrix(iter->second, params, derivative, k);
+  return mat;
+}
+} // namespace
+
+StateVector::StateVector(const std::size_t n_qubits)
+    : m_nbQubits(n_qubits),
+      m_state(Eigen::VectorXcd::Zero(1ULL << n_qubits)) {
+  m_state(0) = 1.0;
+}
+
+StateVector::StateVector(const Eigen::VectorXcd &amplitudes)
+    : m_nbQubits(0), m_state(amplitudes) {
+  while ((1ULL << m_nbQubits) < (std::size_t)amplitudes.size()) {
+    m_nbQubits++;
+  }
+  if ((1ULL << m_nbQubits) != (std::size_t)amplitudes.size()) {
+    xacc::error("StateVector: invalid number of amplitudes " +
+                std::to_string(amplitudes.size()));
+  }
+}
+
+void StateVector::apply(std::shared_ptr<xacc::Instruction> inst) {
+  apply_gate(inst, GateMode::Forward, 0);
+}
+
+void StateVector::apply(std::shared_ptr<xacc::CompositeInstruction> program) {
+  for (auto &inst : flatten(program)) {
+    apply_gate(inst, GateMode::Forward, 0);
+  }
+}
+
+void StateVector::apply_adjoint(std::shared_ptr<xacc::Instruction> inst) {
+  apply_gate(inst, GateMode::Adjoint, 0);
+}
+
+void StateVector::apply_derivative(std::shared_ptr<xacc::Instruction> inst,
+                                   const std::size_t param_idx) {
+  apply_gate(inst, GateMode::Derivative, param_idx);
+}
+
+void StateVector::apply_gate(std::shared_ptr<xacc::Instruction> inst,
+                             GateMode mode, const std::size_t param_idx) {
+  const auto name = inst->name();
+  if (name == "Measure") {
+    if (mode == GateMode::Derivative) {
+      xacc::error("StateVector: cannot differentiate Measure.");
+    }
+    return;
+  }
+
+  const auto params = get_parameters(inst);
+  const bool derivative = mode == GateMode::Derivative;
+  const auto bits = inst->bits();
+  if (SINGLE_QUBIT_GATES.count(name)) {
+    Eigen::Matrix2cd mat =
+        single_qubit_matrix(name, params, derivative, param_idx);
+    if (mode == GateMode::Adjoint) {
+      mat.adjointInPlace();
+    }
+    apply_single_qubit(mat, bits[0]);
+  } else if (TWO_QUBIT_GATES.count(name)) {
+    Eigen::Matrix4cd mat =
+        two_qubit_matrix(name, params, derivative, param_idx);
+    if (mode == GateMode::Adjoint) {
+      mat.adjointInPlace();
+    }
+    apply_two_qubit(mat, bits[0], bits[1]);
+  } else {
+    xacc::error("StateVector: unsupported gate " + name);
+  }
+}
+
+void StateVector::apply_single_qubit(const Eigen::Matrix2cd &mat,
+                                     const std::size_t q) {
+  const std::size_t mask = 1ULL << q;
+  const std::size_t dim = m_state.size();
+  for (std::size_t i = 0; i < dim; ++i) {
+    if (i & mask) {
+      continue;
+    }
+    const auto a0 = m_state(i);
+    const auto a1 = m_state(i | mask);
+    m_state(i) = mat(0, 0) * a0 + mat(0, 1) * a1;
+    m_state(i | mask) = mat(1, 0) * a0 + mat(1, 1) * a1;
+  }
+}
+
+void StateVector::apply_two_qubit(const Eigen::Matrix4cd &mat,
+                                  const std::size_t q0, const std::size_t q1) {
+  const std::size_t m0 = 1ULL << q0;
+  const std::size_t m1 = 1ULL << q1;
+  const std::size_t dim = m_state.size();
+  for (std::size_t i = 0; i < dim; ++i) {
+    if ((i & m0) || (i & m1)) {
+      continue;
+    }
+    const std::size_t idx[4] = {i, i | m1, i | m0, i | m0 | m1};
+    Eigen::Vector4cd local;
+    for (int j = 0; j < 4; j++) {
+      local(j) = m_state(idx[j]);
+    }
+    local = mat * local;
+    for (int j = 0; j < 4; j++) {
+      m_state(idx[j]) = local(j);
+    }
+  }
+}
+
+StateVector StateVector::apply(xacc::quantum::PauliOperator &op) const {
+  StateVector result(Eigen::VectorXcd::Zero(m_state.size()));
+  const std::size_t dim = m_state.size();
+  for (auto &[termStr, term] : op.getTerms()) {
+    // P |i> = i^{nY} (-1)^{|i & zmask|} |i ^ xmask>
+    std::size_t xmask = 0, zmask = 0;
+    int nY = 0;
+    for (auto &[bitIdx, pauliOpStr] : term.ops()) {
+      if (bitIdx >= (int)m_nbQubits) {
+        xacc::error("StateVector: operator acts on qubit " +
+                    std::to_string(bitIdx) + ", state has " +
+                    std::to_string(m_nbQubits) + " qubits.");
+      }
+      if (pauliOpStr == "X") {
+        xmask |= 1ULL << bitIdx;
+      } else if (pauliOpStr == "Y") {
+        xmask |= 1ULL << bitIdx;
+        zmask |= 1ULL << bitIdx;
+        nY++;
+      } else if (pauliOpStr == "Z") {
+        zmask |= 1ULL << bitIdx;
+      }
+    }
+    std::complex<double> phase = term.coeff();
+    for (int i = 0; i < nY % 4; i++) {
+      phase *= I_unit;
+    }
+    for (std::size_t i = 0; i < dim; ++i) {
+      const bool odd = __builtin_popcountll(i & zmask) & 1;
+      result.m_state(i ^ xmask) += (odd ? -phase : phase) * m_state(i);
+    }
+  }
+  return result;
+}
+
+double StateVector::expectation(xacc::quantum::PauliOperator &op) const {
+  return std::real(inner(apply(op)));
+}
+
+std::complex<double> StateVector::inner(const StateVector &other) const {
+  return m_state.dot(other.m_state);
+}
+
+bool StateVector::is_supported(std::shared_ptr<xacc::Instruction> inst) {
+  const auto name = inst->name();
+  return name == "Measure" || SINGLE_QUBIT_GATES.count(name) ||
+         TWO_QUBIT_GATES.count(name);
+}
+
+std::vector<std::shared_ptr<xacc::Instruction>>
+StateVector::flatten(std::shared_ptr<xacc::CompositeInstruction> program) {
+  std::vector<std::shared_ptr<xacc::Instruction>> insts;
+  xacc::InstructionIterator iter(program);
+  while (iter.hasNext()) {
+    auto next = iter.next();
+    if (!next->isComposite() && next->isEnabled()) {
+      insts.emplace_back(next);
+    }
+  }
+  return insts;
+}
+
+std::size_t StateVector::required_qubits(
+    std::shared_ptr<xacc::CompositeInstruction> program) {
+  std::size_t n = 0;
+  for (auto &inst : flatten(program)) {
+    for (auto bit : inst->bits()) {
+      n = std::max<std::size_t>(n, bit + 1);
+    }
+  }
+  return n;
+}
+} // namespace qcor
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "CompositeInstruction.hpp"
+
+namespace xacc {
+namespace quantum {
+class PauliOperator;
+}
+} // namespace xacc
+
+namespace qcor {
+
+// Simple dense state-vector representation of an n-qubit register.
+// This is used by qcor utilities that need direct access to the
+// wavefunction (e.g. adjoint gradients) rather than going
+// through an xacc Accelerator. Qubit i is mapped to bit i
+// of the amplitude index (little-endian).
+//
+// Supported gates: H, X, Y, Z, S, Sdg, T, Tdg, I, Rx, Ry, Rz, U1, U,
+// CNOT, CY, CZ, CH, Swap, CRZ, CPhase. Measure is ignored.
+class StateVector {
+public:
+  // Create the |0...0> state
+  StateVector(const std::size_t n_qubits);
+  // Create a state from the given amplitudes (size must be 2^n)
+  StateVector(const Eigen::VectorXcd &amplitudes);
+
+  std::size_t n_qubits() const { return m_nbQubits; }
+  const Eigen::VectorXcd &amplitudes() const { return m_state; }
+  Eigen::VectorXcd &amplitudes() { return m_state; }
+
+  // Apply the gate U
+  void apply(std::shared_ptr<xacc::Instruction> inst);
+  // Apply the full (flattened) program
+  void apply(std::shared_ptr<xacc::CompositeInstruction> program);
+  // Apply U^dagger
+  void apply_adjoint(std::shared_ptr<xacc::Instruction> inst);
+  // Apply dU/d(theta_k), k = parameter index of the gate.
+  // Note: the result is not a normalized state.
+  void apply_derivative(std::shared_ptr<xacc::Instruction> inst,
+                        const std::size_t param_idx = 0);
+
+  // Apply an arbitrary 2x2 matrix on qubit q
+  void apply_single_qubit(const Eigen::Matrix2cd &mat, const std::size_t q);
+  // Apply an arbitrary 4x4 matrix on (q0, q1), the matrix row
+  // index is 2 * bit(q0) + bit(q1), i.e. CNOT(q0, q1) has q0 as control.
+  void apply_two_qubit(const Eigen::Matrix4cd &mat, const std::size_t q0,
+                       const std::size_t q1);
+
+  // Return H |psi>, H a Pauli operator (not normalized)
+  StateVector apply(xacc::quantum::PauliOperator &op) const;
+  // Return <psi| H |psi>
+  double expectation(xacc::quantum::PauliOperator &op) const;
+  // Return <this|other>
+  std::complex<double> inner(const StateVector &other) const;
+
+  // Return true if this gate can be simulated by StateVector
+  static bool is_supported(std::shared_ptr<xacc::Instruction> inst);
+  // Return all enabled, non-composite instructions in the program
+  static std::vector<std::shared_ptr<xacc::Instruction>>
+  flatten(std::shared_ptr<xacc::CompositeInstruction> program);
+  // Return the number of qubits needed to simulate the program
+  static std::size_t
+  required_qubits(std::shared_ptr<xacc::CompositeInstruction> program);
+
+private:
+  enum class GateMode { Forward, Adjoint, Derivative };
+  void apply_gate(std::shared_ptr<xacc::Instruction> inst, GateMode mode,
+                  const std::size_t param_idx);
+
+  std::size_t m_nbQubits;
+  Eigen::VectorXcd m_state;
+};
+} // namespace qcor
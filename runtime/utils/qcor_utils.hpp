@@ -150,6 +150,12 @@ using GradientEvaluator =
 
 namespace __internal__ {
 
+// Non-owning shared_ptr to t
+template <typename T>
+std::shared_ptr<T> qcor_as_shared(T *t) {
+  return std::shared_ptr<T>(t, [](T *const) {});
+}
+
 void append_plugin_path(const std::string path);
 
 // Internal function for creating a CompositeInstruction, this lets us
@@ -1,6 +1,12 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/CodeGen/CodeGenAction.h"
@@ -9,9 +15,13 @@
 #include "clang/Driver/Tool.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Frontend/Utils.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
@@ -25,7 +35,9 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "qcor_clang_wrapper.hpp"
@@ -36,34 +48,49 @@ using namespace llvm;
 
 namespace qcor {
 
-llvm::ExitOnError ExitOnErr;
+llvm::ExitOnError ExitOnErr("clang interpreter");
 std::string GetExecutablePath(const char *Argv0, void *MainAddr) {
   return llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
 }
 
-std::unique_ptr<clang::CodeGenAction> emit_llvm_ir(
-    const std::string src_code, std::vector<std::string> extra_headers) {
-  // Persist the src code to a temporary file
-  std::string internal_file_name = ".__qcor_internal_llvm_ir_emitter.cpp";
-  std::ofstream file(internal_file_name);
-  file << src_code;
-  file.close();
+namespace {
+// The standard include set of the JIT-compiled kernels. It is precompiled
+// once (see get_preamble_pch) and served from the in-memory overlay.
+const std::string preamble_file_name = "/__qcor_internal__/qjit_preamble.hpp";
+const std::string preamble_src = "#include \"qcor.hpp\"\n";
 
-  // Define the Clang command line
-  std::vector<std::string> argv_vec{"@CLANG_EXECUTABLE@", "-std=c++17"};
-  std::vector<std::string> base_includes{
-      "-I@XACC_ROOT@/include/xacc", "-I@XACC_ROOT@/include/pybind11/include",
-      "-I@CMAKE_INSTALL_PREFIX@/include/qcor",
-      "-I@XACC_ROOT@/include/quantum/gate", "-I@XACC_ROOT@/include/eigen"};
-  for (auto extra : extra_headers) {
-    base_includes.push_back(extra);
+std::string sha1_hex(const std::string &content) {
+  const auto digest = llvm::SHA1::hash(llvm::arrayRefFromStringRef(content));
+  std::string hex;
+  for (const auto byte : digest) {
+    hex += llvm::hexdigit(byte >> 4, true);
+    hex += llvm::hexdigit(byte & 0xF, true);
   }
-  for (auto include : base_includes) {
-    argv_vec.push_back(include);
+  return hex;
+}
+
+// Atomically write a file (temporary file + rename)
+bool write_file_atomic(const std::string &file_name,
+                       const std::string &content) {
+  std::stringstream tmp_name;
+  tmp_name << file_name << ".tmp" << getpid() << "_"
+           << std::this_thread::get_id();
+  {
+    std::ofstream out(tmp_name.str(), std::ios::binary);
+    out << content;
+    if (!out) {
+      std::remove(tmp_name.str().c_str());
+      return false;
+    }
   }
-  argv_vec.push_back("-c");
-  argv_vec.push_back(internal_file_name.c_str());
+  return std::rename(tmp_name.str().c_str(), file_name.c_str()) == 0;
+}
 
+// Create the compiler (-cc1) invocation of a clang driver command line,
+// which must consist of exactly one clang job.
+std::unique_ptr<CompilerInvocation> create_invocation(
+    const std::vector<std::string> &argv_vec, DiagnosticsEngine &Diags,
+    IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS) {
   std::vector<const char *> tmp_argv(argv_vec.size(), nullptr);
   for (int i = 0; i < argv_vec.size(); i++) {
     tmp_argv[i] = argv_vec[i].c_str();
@@ -72,22 +99,13 @@ std::unique_ptr<clang::CodeGenAction> emit_llvm_ir(
   // Create argc and argv
   const char **argv = &tmp_argv[0];
   int argc = argv_vec.size();
-  void *MainAddr = (void *)(intptr_t)GetExecutablePath;
   std::string Path = "@LLVM_INSTALL_PREFIX@/bin/clang++";
-  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
-  TextDiagnosticPrinter *DiagClient =
-      new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
-
-  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
-  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagClient);
 
   const std::string TripleStr = llvm::sys::getProcessTriple();
   llvm::Triple T(TripleStr);
 
-  ExitOnErr.setBanner("clang interpreter");
-
   // Create the Clang driver
-  Driver TheDriver(Path, T.str(), Diags);
+  Driver TheDriver(Path, T.str(), Diags, FS);
   TheDriver.setTitle("clang interpreter");
   TheDriver.setCheckInputsExist(false);
 
@@ -95,7 +113,6 @@ std::unique_ptr<clang::CodeGenAction> emit_llvm_ir(
   // recognize. We need to extend the driver library to support this use model
   // (basically, exactly one input, and the operation mode is hard wired).
   SmallVector<const char *, 16> Args(argv, argv + argc);
-  Args.push_back("-fsyntax-only");
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(Args));
   if (!C) {
     std::cout << "QCOR internal clang execution error. Could not create the "
@@ -125,9 +142,15 @@ std::unique_ptr<clang::CodeGenAction> emit_llvm_ir(
   const llvm::opt::ArgStringList &CCArgs = Cmd.getArguments();
   std::unique_ptr<CompilerInvocation> CI(new CompilerInvocation);
   CompilerInvocation::CreateFromArgs(*CI, CCArgs, Diags);
+  return CI;
+}
 
-  // Create a compiler instance to handle the actual work.
-  CompilerInstance Clang;
+// Create a compiler instance for the invocation, reading files
+// through the given file system.
+void setup_compiler(CompilerInstance &Clang,
+                    std::unique_ptr<CompilerInvocation> CI,
+                    IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS,
+                    const char *Argv0) {
   Clang.setInvocation(std::move(CI));
 
   // Create the compilers actual diagnostics engine.
@@ -137,11 +160,163 @@ std::unique_ptr<clang::CodeGenAction> emit_llvm_ir(
     exit(1);
   }
 
+  Clang.createFileManager(FS);
+
   // Infer the builtin include path if unspecified.
+  void *MainAddr = (void *)(intptr_t)GetExecutablePath;
   if (Clang.getHeaderSearchOpts().UseBuiltinIncludes &&
       Clang.getHeaderSearchOpts().ResourceDir.empty())
     Clang.getHeaderSearchOpts().ResourceDir =
-        CompilerInvocation::GetResourcesPath(argv[0], MainAddr);
+        CompilerInvocation::GetResourcesPath(Argv0, MainAddr);
+}
+
+// Return true if none of the headers recorded in the deps file
+// (mtime, size, path lines) has changed.
+bool pch_deps_up_to_date(const std::string &deps_file_name) {
+  std::ifstream deps_file(deps_file_name);
+  long long mtime;
+  long long size;
+  std::string path;
+  bool has_deps = false;
+  while (deps_file >> mtime >> size &&
+         std::getline(deps_file >> std::ws, path)) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || st.st_mtime != mtime ||
+        st.st_size != size) {
+      return false;
+    }
+    has_deps = true;
+  }
+  return has_deps;
+}
+
+// Return the path of the precompiled preamble for this command line
+// (without its input file), building it if it doesn't exist or if any of
+// the headers it was built from has changed. PCHs are stored in
+// ~/.qjit/pch, keyed by the command line and the LLVM/qcor builds.
+// Returns an empty string if the PCH is disabled ($QJIT_DISABLE_PCH)
+// or could not be built.
+std::string get_preamble_pch(const std::vector<std::string> &base_argv,
+                             DiagnosticsEngine &Diags,
+                             IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS) {
+  const char *home = std::getenv("HOME");
+  if (std::getenv("QJIT_DISABLE_PCH") || !home) {
+    return "";
+  }
+
+  // Serialize the PCH builds of this process, concurrent processes
+  // never read a partially written PCH (atomic rename).
+  static std::mutex pch_mutex;
+  std::lock_guard<std::mutex> lock(pch_mutex);
+
+  const std::string pch_dir = std::string(home) + "/.qjit/pch";
+  if (llvm::sys::fs::create_directories(pch_dir)) {
+    return "";
+  }
+  std::string key_material = "llvm " LLVM_VERSION_STRING "\n";
+  key_material += "qcor " __DATE__ " " __TIME__ "\n";
+  key_material += preamble_src;
+  for (const auto &arg : base_argv) {
+    key_material += arg + "\n";
+  }
+  const std::string pch_file_name =
+      pch_dir + "/qjit_preamble_" + sha1_hex(key_material) + ".pch";
+  const std::string deps_file_name = pch_file_name + ".deps";
+  if (llvm::sys::fs::exists(pch_file_name) &&
+      pch_deps_up_to_date(deps_file_name)) {
+    return pch_file_name;
+  }
+
+  // (Re)build the PCH
+  std::stringstream tmp_name;
+  tmp_name << pch_file_name << ".tmp" << getpid() << "_"
+           << std::this_thread::get_id();
+  std::vector<std::string> argv_vec(base_argv);
+  argv_vec.insert(argv_vec.end(), {"-x", "c++-header", preamble_file_name,
+                                   "-o", tmp_name.str()});
+  CompilerInstance Clang;
+  setup_compiler(Clang, create_invocation(argv_vec, Diags, FS), FS,
+                 argv_vec[0].c_str());
+  auto deps = std::make_shared<DependencyCollector>();
+  Clang.addDependencyCollector(deps);
+  GeneratePCHAction Act;
+  if (!Clang.ExecuteAction(Act)) {
+    std::remove(tmp_name.str().c_str());
+    return "";
+  }
+
+  std::stringstream deps_ss;
+  for (const auto &dep : deps->getDependencies()) {
+    struct stat st;
+    if (stat(dep.c_str(), &st) == 0) {
+      deps_ss << (long long)st.st_mtime << " " << (long long)st.st_size << " "
+              << dep << "\n";
+    }
+  }
+  if (std::rename(tmp_name.str().c_str(), pch_file_name.c_str()) != 0 ||
+      !write_file_atomic(deps_file_name, deps_ss.str())) {
+    return "";
+  }
+  return pch_file_name;
+}
+}  // namespace
+
+std::unique_ptr<clang::CodeGenAction> emit_llvm_ir(
+    const std::string src_code, std::vector<std::string> extra_headers) {
+  // Serve the src code from an in-memory file overlaid on the real
+  // file system (headers are still read from disk). The file name is
+  // unique per process and call, so that concurrent compiles never clash.
+  static std::atomic<std::size_t> emitter_counter(0);
+  const std::string internal_file_name =
+      "/__qcor_internal__/llvm_ir_emitter_" + std::to_string(getpid()) + "_" +
+      std::to_string(emitter_counter++) + ".cpp";
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemoryFS(
+      new llvm::vfs::InMemoryFileSystem());
+  InMemoryFS->addFile(
+      internal_file_name, 0,
+      llvm::MemoryBuffer::getMemBufferCopy(src_code, internal_file_name));
+  InMemoryFS->addFile(
+      preamble_file_name, 0,
+      llvm::MemoryBuffer::getMemBufferCopy(preamble_src, preamble_file_name));
+  IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> OverlayFS(
+      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
+  OverlayFS->pushOverlay(InMemoryFS);
+
+  // Define the Clang command line
+  std::vector<std::string> argv_vec{"@CLANG_EXECUTABLE@", "-std=c++17"};
+  std::vector<std::string> base_includes{
+      "-I@XACC_ROOT@/include/xacc", "-I@XACC_ROOT@/include/pybind11/include",
+      "-I@CMAKE_INSTALL_PREFIX@/include/qcor",
+      "-I@XACC_ROOT@/include/quantum/gate", "-I@XACC_ROOT@/include/eigen"};
+  for (auto extra : extra_headers) {
+    base_includes.push_back(extra);
+  }
+  for (auto include : base_includes) {
+    argv_vec.push_back(include);
+  }
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticPrinter *DiagClient =
+      new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
+
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagClient);
+
+  // Reuse the precompiled standard includes if possible
+  const auto pch_file_name = get_preamble_pch(argv_vec, Diags, OverlayFS);
+  if (!pch_file_name.empty()) {
+    argv_vec.push_back("-include-pch");
+    argv_vec.push_back(pch_file_name);
+  }
+
+  argv_vec.push_back("-c");
+  argv_vec.push_back(internal_file_name.c_str());
+  argv_vec.push_back("-fsyntax-only");
+
+  // Create a compiler instance to handle the actual work.
+  CompilerInstance Clang;
+  setup_compiler(Clang, create_invocation(argv_vec, Diags, OverlayFS),
+                 OverlayFS, argv_vec[0].c_str());
 
   // Create and execute the frontend to generate an LLVM bitcode module.
   std::unique_ptr<CodeGenAction> Act(new EmitLLVMOnlyAction());
@@ -149,9 +324,12 @@ std::unique_ptr<clang::CodeGenAction> emit_llvm_ir(
     std::cout << "Error in executing clang codegen.\n";
   }
 
-  llvm::InitializeNativeTarget();
-  llvm::InitializeNativeTargetAsmPrinter();
-  std::remove(internal_file_name.c_str());
+  // Target registration is not thread-safe
+  static std::once_flag init_target_flag;
+  std::call_once(init_target_flag, []() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  });
 
   return Act;
 }
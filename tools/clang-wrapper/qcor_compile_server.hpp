@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace qcor {
+namespace compile_server {
+// Protocol of the local compile server (qcor-server), a long-lived process
+// that keeps XACC, the qcor syntax handler plugins and the QJIT
+// precompiled header loaded across compiles.
+//
+// Messages are exchanged over a UNIX socket, one request per connection.
+// A message is a list of strings: [uint32 count] then [uint32 size, bytes]
+// for each string (host byte order). env is the client environment, as
+// NAME=value entries separated by '\0'. Requests:
+//   ["ping"]                        -> [protocol_version, build_id]
+//   ["compile", env, cwd, argv...] + 2 fds
+//                                   -> [exit code]
+//     Runs a clang++ command line (argv[0] is ignored) in cwd, with the
+//     client environment and the given fds (client stdout, stderr) as
+//     stdout and stderr.
+//   ["emit-llvm", env, code, extra_headers...]
+//                                   -> ["0", bitcode] or ["1"]
+//     Compiles QJIT kernel code to LLVM bitcode.
+//   ["shutdown"]                    -> ["0"]
+const std::string protocol_version = "qcor-server-v2";
+
+// $QCOR_SERVER_SOCKET, default $HOME/.qjit/qcor-server.sock
+std::string socket_path();
+
+// Identifies the installed qcor build (version and syntax handler plugin).
+std::string build_id();
+
+// The environment of this process, in the request format.
+std::string environment();
+
+// Connect to the server socket, return -1 if nothing is listening.
+int open_connection();
+
+// Connect to a running server of the same protocol version and qcor build,
+// return -1 if there is none or it is disabled ($QCOR_DISABLE_SERVER is
+// set).
+int connect_to_server();
+
+// Send/receive a message, with optional file descriptors (SCM_RIGHTS).
+bool send_message(int fd, const std::vector<std::string> &message,
+                  const std::vector<int> &fds = {});
+bool recv_message(int fd, std::vector<std::string> &message,
+                  std::vector<int> *fds = nullptr);
+
+// Client side of "emit-llvm": return false if the server is not
+// running or the compile failed (callers compile locally then).
+bool emit_llvm_bitcode(const std::string &code,
+                       const std::vector<std::string> &extra_headers,
+                       std::string &bitcode);
+}  // namespace compile_server
+}  // namespace qcor
@@ -0,0 +1,252 @@
+#include "qcor_compile_server.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+extern char **environ;
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif
+
+namespace qcor {
+namespace compile_server {
+namespace {
+constexpr std::size_t max_fds = 4;
+
+bool write_all(int fd, const char *data, std::size_t size) {
+  while (size > 0) {
+    const auto n = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool read_all(int fd, char *data, std::size_t size) {
+  while (size > 0) {
+    const auto n = ::read(fd, data, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+}  // namespace
+
+std::string socket_path() {
+  if (const char *path = std::getenv("QCOR_SERVER_SOCKET")) {
+    return path;
+  }
+  const char *home = std::getenv("HOME");
+  return std::string(home ? home : "/tmp") + "/.qjit/qcor-server.sock";
+}
+
+std::string build_id() {
+  std::string version = "unknown";
+  std::ifstream version_file("@CMAKE_INSTALL_PREFIX@/include/qcor/qcor_version");
+  if (version_file) {
+    std::stringstream ss;
+    ss << version_file.rdbuf();
+    version = ss.str();
+    while (!version.empty() && std::isspace((unsigned char)version.back())) {
+      version.pop_back();
+    }
+  }
+  struct stat st;
+  const long long plugin_mtime =
+      ::stat("@CMAKE_INSTALL_PREFIX@/clang-plugins/"
+             "libqcor-syntax-handler@CMAKE_SHARED_LIBRARY_SUFFIX@",
+             &st) == 0
+          ? (long long)st.st_mtime
+          : 0;
+  return version + " " + std::to_string(plugin_mtime);
+}
+
+std::string environment() {
+  std::string env;
+  for (char **var = environ; var && *var; var++) {
+    if (!env.empty()) env += '\0';
+    env += *var;
+  }
+  return env;
+}
+
+int open_connection() {
+  const auto path = socket_path();
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    return -1;
+  }
+  std::strcpy(addr.sun_path, path.c_str());
+
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int connect_to_server() {
+  if (std::getenv("QCOR_DISABLE_SERVER")) {
+    return -1;
+  }
+  // Only use a server of the same protocol and qcor build (e.g. not one
+  // left running across a reinstall).
+  const int ping_fd = open_connection();
+  if (ping_fd < 0) {
+    return -1;
+  }
+  std::vector<std::string> response;
+  const bool compatible = send_message(ping_fd, {"ping"}) &&
+                          recv_message(ping_fd, response) &&
+                          response.size() == 2 &&
+                          response[0] == protocol_version &&
+                          response[1] == build_id();
+  ::close(ping_fd);
+  return compatible ? open_connection() : -1;
+}
+
+bool send_message(int fd, const std::vector<std::string> &message,
+                  const std::vector<int> &fds) {
+  if (fds.size() > max_fds) {
+    return false;
+  }
+  // The file descriptors travel with the count (first bytes)
+  std::uint32_t count = message.size();
+  iovec iov;
+  iov.iov_base = &count;
+  iov.iov_len = sizeof(count);
+  msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(max_fds * sizeof(int))];
+  if (!fds.empty()) {
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(fds.size() * sizeof(int));
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(fds.size() * sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), fds.data(), fds.size() * sizeof(int));
+  }
+  ssize_t n;
+  do {
+    n = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  if (n != sizeof(count)) {
+    return false;
+  }
+
+  for (const auto &str : message) {
+    std::uint32_t size = str.size();
+    if (!write_all(fd, reinterpret_cast<const char *>(&size), sizeof(size)) ||
+        !write_all(fd, str.data(), str.size())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool recv_message(int fd, std::vector<std::string> &message,
+                  std::vector<int> *fds) {
+  message.clear();
+  std::uint32_t count = 0;
+  iovec iov;
+  iov.iov_base = &count;
+  iov.iov_len = sizeof(count);
+  msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(max_fds * sizeof(int))];
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  ssize_t n;
+  do {
+    n = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    return false;
+  }
+
+  for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      const auto nb_fds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      for (std::size_t i = 0; i < nb_fds; i++) {
+        int received;
+        std::memcpy(&received, CMSG_DATA(cmsg) + i * sizeof(int),
+                    sizeof(int));
+        if (fds) {
+          fds->push_back(received);
+        } else {
+          ::close(received);
+        }
+      }
+    }
+  }
+  // Short read of the count
+  if (n < static_cast<ssize_t>(sizeof(count)) &&
+      !read_all(fd, reinterpret_cast<char *>(&count) + n, sizeof(count) - n)) {
+    return false;
+  }
+
+  for (std::uint32_t i = 0; i < count; i++) {
+    std::uint32_t size = 0;
+    if (!read_all(fd, reinterpret_cast<char *>(&size), sizeof(size))) {
+      return false;
+    }
+    std::string str(size, '\0');
+    if (size > 0 && !read_all(fd, &str[0], size)) {
+      return false;
+    }
+    message.emplace_back(std::move(str));
+  }
+  return true;
+}
+
+bool emit_llvm_bitcode(const std::string &code,
+                       const std::vector<std::string> &extra_headers,
+                       std::string &bitcode) {
+  const int fd = connect_to_server();
+  if (fd < 0) {
+    return false;
+  }
+  std::vector<std::string> request{"emit-llvm", environment(), code};
+  request.insert(request.end(), extra_headers.begin(), extra_headers.end());
+  std::vector<std::string> response;
+  const bool ok = send_message(fd, request) && recv_message(fd, response) &&
+                  response.size() == 2 && response[0] == "0";
+  ::close(fd);
+  if (ok) {
+    bitcode = std::move(response[1]);
+  }
+  return ok;
+}
+}  // namespace compile_server
+}  // namespace qcor
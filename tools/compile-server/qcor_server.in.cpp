@@ -0,0 +1,382 @@
+// qcor-server: a long-lived local compile server. It keeps XACC, the qcor
+// syntax handler (and its token collectors) and the QJIT precompiled header
+// loaded, and serves compile requests of the qcor driver and of QJIT over a
+// UNIX socket (see qcor_compile_server.hpp for the protocol).
+//
+// Usage: qcor-server [--socket path]   run the server (foreground)
+//        qcor-server --status          check if a server is running
+//        qcor-server --stop            stop the running server
+//
+// Compile requests are served concurrently, each in a child process
+// forked from the (warmed up) server: it runs in the working directory and
+// the environment of the client, with the client's stdout and stderr.
+// At most $QCOR_SERVER_JOBS (default: number of cores) requests run at
+// once. A client must send its request within $QCOR_SERVER_TIMEOUT seconds
+// (default 10) of connecting.
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/CodeGen/CodeGenAction.h"
+#include "clang/Driver/Compilation.h"
+#include "clang/Driver/Driver.h"
+#include "clang/Driver/ToolChain.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/TextDiagnosticBuffer.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/FrontendTool/Utils.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "qcor_clang_wrapper.hpp"
+#include "qcor_compile_server.hpp"
+
+extern char **environ;
+
+using namespace clang::driver;
+using namespace clang;
+using namespace llvm;
+using namespace qcor::compile_server;
+
+namespace {
+const std::string clang_path = "@LLVM_INSTALL_PREFIX@/bin/clang++";
+const std::string syntax_handler_plugin =
+    "@CMAKE_INSTALL_PREFIX@/clang-plugins/"
+    "libqcor-syntax-handler@CMAKE_SHARED_LIBRARY_SUFFIX@";
+
+std::string GetExecutablePath(const char *Argv0) {
+  void *MainAddr = (void *)(intptr_t)GetExecutablePath;
+  return llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+}
+
+// In-process clang -cc1 (Driver::CC1Main), the compiler
+// instance is freed after each job.
+int run_cc1(SmallVectorImpl<const char *> &ArgV) {
+  if (ArgV.size() < 2 || StringRef(ArgV[1]) != "-cc1") {
+    llvm::errs() << "qcor-server: only clang -cc1 jobs are supported\n";
+    return 1;
+  }
+  std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
+  bool Success = CompilerInvocation::CreateFromArgs(
+      Clang->getInvocation(), makeArrayRef(ArgV).slice(2), Diags);
+  Clang->getFrontendOpts().DisableFree = false;
+
+  // Infer the builtin include path if unspecified.
+  if (Clang->getHeaderSearchOpts().UseBuiltinIncludes &&
+      Clang->getHeaderSearchOpts().ResourceDir.empty())
+    Clang->getHeaderSearchOpts().ResourceDir =
+        CompilerInvocation::GetResourcesPath(
+            ArgV[0], (void *)(intptr_t)GetExecutablePath);
+
+  Clang->createDiagnostics();
+  if (!Clang->hasDiagnostics()) return 1;
+  DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
+  if (!Success) return 1;
+
+  Success = ExecuteCompilerInvocation(Clang.get());
+  return !Success;
+}
+
+// Run a clang++ driver command line (compile and/or link)
+int run_compile(const std::string &cwd, const std::vector<std::string> &args) {
+  if (::chdir(cwd.c_str()) != 0) {
+    llvm::errs() << "qcor-server: could not change directory to " << cwd
+                 << "\n";
+    return 1;
+  }
+  std::vector<const char *> argv{clang_path.c_str()};
+  for (std::size_t i = 1; i < args.size(); i++) {
+    argv.push_back(args[i].c_str());
+  }
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticPrinter *DiagClient =
+      new TextDiagnosticPrinter(llvm::errs(), &*DiagOpts);
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagClient);
+
+  Driver TheDriver(clang_path, llvm::sys::getDefaultTargetTriple(), Diags);
+  TheDriver.setTargetAndMode(
+      ToolChain::getTargetAndModeFromProgramName(clang_path));
+  TheDriver.CC1Main = &run_cc1;
+  std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
+  if (!C || C->containsError()) {
+    return 1;
+  }
+  SmallVector<std::pair<int, const Command *>, 4> FailingCommands;
+  int Res = TheDriver.ExecuteCompilation(*C, FailingCommands);
+  for (const auto &P : FailingCommands) {
+    if (!Res) Res = P.first;
+  }
+  return Res;
+}
+
+std::vector<std::string> run_emit_llvm(const std::vector<std::string> &request) {
+  std::vector<std::string> extra_headers(request.begin() + 3, request.end());
+  auto act = qcor::emit_llvm_ir(request[2], extra_headers);
+  std::string bitcode;
+  {
+    // The Module must be released before the action (its context)
+    auto module = act->takeModule();
+    if (!module) {
+      return {"1"};
+    }
+    llvm::raw_string_ostream bitcode_os(bitcode);
+    WriteBitcodeToFile(*module, bitcode_os);
+  }
+  return {"0", bitcode};
+}
+
+// Replace the environment of the (request) process by the client one
+void set_environment(const std::string &env) {
+  std::vector<std::string> names;
+  for (char **var = environ; var && *var; var++) {
+    const std::string entry = *var;
+    names.push_back(entry.substr(0, entry.find('=')));
+  }
+  for (const auto &name : names) {
+    ::unsetenv(name.c_str());
+  }
+  std::size_t start = 0;
+  while (start < env.size()) {
+    auto end = env.find('\0', start);
+    if (end == std::string::npos) end = env.size();
+    const auto entry = env.substr(start, end - start);
+    const auto eq = entry.find('=');
+    if (eq != std::string::npos && eq > 0) {
+      ::setenv(entry.substr(0, eq).c_str(), entry.substr(eq + 1).c_str(), 1);
+    }
+    start = end + 1;
+  }
+}
+
+// Serve a compile or emit-llvm request (in a child process)
+std::vector<std::string> serve(const std::vector<std::string> &request,
+                               const std::vector<int> &fds) {
+  set_environment(request[1]);
+  if (request[0] == "emit-llvm") {
+    return run_emit_llvm(request);
+  }
+  // Use the client stdout/stderr
+  ::dup2(fds[0], STDOUT_FILENO);
+  ::dup2(fds[1], STDERR_FILENO);
+  const int result = run_compile(
+      request[2], std::vector<std::string>(request.begin() + 3, request.end()));
+  return {std::to_string(result)};
+}
+
+// Compile a trivial kernel so that XACC and the token collectors
+// are initialized (and the plugins loaded) before the first request.
+void warm_up() {
+  SmallString<128> tmp_file;
+  if (llvm::sys::fs::createTemporaryFile("qcor_server_warm_up", "cpp",
+                                         tmp_file)) {
+    return;
+  }
+  {
+    std::ofstream out(tmp_file.c_str());
+    out << "__qpu__ void __qcor_server_warm_up(qreg q) { H(q[0]); }\n";
+  }
+  char cwd[PATH_MAX];
+  if (::getcwd(cwd, sizeof(cwd))) {
+    run_compile(cwd,
+                {clang_path, "-std=c++17", "-fplugin=" + syntax_handler_plugin,
+                 "-I@XACC_ROOT@/include/xacc",
+                 "-I@CMAKE_INSTALL_PREFIX@/include/qcor",
+                 "-I@XACC_ROOT@/include/quantum/gate",
+                 "-I@XACC_ROOT@/include/eigen", "-fsyntax-only",
+                 tmp_file.str().str()});
+  }
+  llvm::sys::fs::remove(tmp_file);
+
+  // Build (or load) the QJIT precompiled header
+  qcor::emit_llvm_ir("");
+}
+
+int send_request(const std::vector<std::string> &request,
+                 std::vector<std::string> &response) {
+  const int fd = open_connection();
+  if (fd < 0) return -1;
+  const bool ok = send_message(fd, request) && recv_message(fd, response);
+  ::close(fd);
+  return ok ? 0 : -1;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+  for (std::size_t i = 0; i < args.size(); i++) {
+    if (args[i] == "--socket" && i + 1 < args.size()) {
+      ::setenv("QCOR_SERVER_SOCKET", args[i + 1].c_str(), 1);
+    }
+  }
+  // The server never forwards to itself
+  ::unsetenv("QCOR_DISABLE_SERVER");
+
+  // Identify the build before anything is loaded
+  const std::string server_build_id = build_id();
+  std::vector<std::string> response;
+  const bool running = send_request({"ping"}, response) == 0;
+  // A server of another build is ignored by the clients.
+  const bool compatible = running && response.size() == 2 &&
+                          response[0] == protocol_version &&
+                          response[1] == server_build_id;
+  for (const auto &arg : args) {
+    if (arg == "--status") {
+      std::cout << "qcor-server is " << (running ? "" : "not ")
+                << "running (" << socket_path() << ")"
+                << (running && !compatible ? ", from another qcor build" : "")
+                << "\n";
+      return compatible ? 0 : 1;
+    }
+    if (arg == "--stop") {
+      return running && send_request({"shutdown"}, response) == 0 ? 0 : 1;
+    }
+  }
+  if (running) {
+    std::cout << "qcor-server is already running (" << socket_path() << ")"
+              << (compatible ? "" : ", from another qcor build: stop it "
+                                    "with qcor-server --stop")
+              << "\n";
+    return compatible ? 0 : 1;
+  }
+
+  ::signal(SIGPIPE, SIG_IGN);
+  llvm::CrashRecoveryContext::Enable();
+
+  // Create the socket (stale socket files are replaced), only
+  // accessible to the current user.
+  const auto path = socket_path();
+  llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path));
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    std::cerr << "qcor-server: socket path too long: " << path << "\n";
+    return 1;
+  }
+  std::strcpy(addr.sun_path, path.c_str());
+  ::unlink(path.c_str());
+  const int server_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  const auto old_mask = ::umask(0077);
+  if (server_fd < 0 ||
+      ::bind(server_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+          0 ||
+      ::listen(server_fd, 64) != 0) {
+    std::cerr << "qcor-server: could not listen on " << path << ": "
+              << std::strerror(errno) << "\n";
+    return 1;
+  }
+  ::umask(old_mask);
+
+  // Keep the syntax handler loaded, compiles only bump its refcount
+  std::string error;
+  if (llvm::sys::DynamicLibrary::LoadLibraryPermanently(
+          syntax_handler_plugin.c_str(), &error)) {
+    std::cerr << "qcor-server: could not load " << syntax_handler_plugin
+              << ": " << error << "\n";
+  }
+  warm_up();
+  std::cout << "qcor-server listening on " << path << std::endl;
+
+  std::size_t max_jobs = std::max(1u, std::thread::hardware_concurrency());
+  if (const char *env = std::getenv("QCOR_SERVER_JOBS")) {
+    max_jobs = std::max(1ul, std::strtoul(env, nullptr, 10));
+  }
+  timeval timeout{10, 0};
+  if (const char *env = std::getenv("QCOR_SERVER_TIMEOUT")) {
+    timeout.tv_sec = std::strtol(env, nullptr, 10);
+  }
+
+  std::size_t nb_jobs = 0;
+  bool shutdown = false;
+  while (!shutdown) {
+    // Reap the finished requests, wait for one if all slots are taken.
+    while (nb_jobs > 0 &&
+           ::waitpid(-1, nullptr, nb_jobs >= max_jobs ? 0 : WNOHANG) > 0) {
+      nb_jobs--;
+    }
+    const int client_fd = ::accept(server_fd, nullptr, nullptr);
+    if (client_fd < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    // A client that sends nothing (or stops reading) times out.
+    ::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                 sizeof(timeout));
+    ::setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                 sizeof(timeout));
+    std::vector<std::string> request;
+    std::vector<int> fds;
+    if (recv_message(client_fd, request, &fds) && !request.empty()) {
+      if (request[0] == "ping") {
+        send_message(client_fd, {protocol_version, server_build_id});
+      } else if (request[0] == "shutdown") {
+        send_message(client_fd, {"0"});
+        shutdown = true;
+      } else if ((request[0] == "compile" && request.size() > 3 &&
+                  fds.size() == 2) ||
+                 (request[0] == "emit-llvm" && request.size() > 2)) {
+        std::cout.flush();
+        std::cerr.flush();
+        llvm::outs().flush();
+        llvm::errs().flush();
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+          ::close(server_fd);
+          const auto child_response = serve(request, fds);
+          std::cout.flush();
+          std::cerr.flush();
+          llvm::outs().flush();
+          llvm::errs().flush();
+          std::fflush(nullptr);
+          send_message(client_fd, child_response);
+          // No static destructors (XACC, plugins) in the request process
+          ::_exit(0);
+        }
+        if (pid > 0) {
+          nb_jobs++;
+        } else {
+          send_message(client_fd, {"1"});
+        }
+      } else {
+        send_message(client_fd, {"1"});
+      }
+    }
+    for (auto fd : fds) {
+      ::close(fd);
+    }
+    ::close(client_fd);
+  }
+
+  while (nb_jobs > 0 && ::waitpid(-1, nullptr, 0) > 0) {
+    nb_jobs--;
+  }
+  ::close(server_fd);
+  ::unlink(path.c_str());
+  return 0;
+}